@@ -0,0 +1,787 @@
+/**
+* @file SharedBridge.hpp
+* @brief Bridge of the shared objects to remote processes over TCP or
+*        Unix sockets.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDBRIDGE_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDBRIDGE_HPP__
+
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <atomic>
+#include <iostream>
+#include <chrono>
+
+#if defined(__unix__)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <limits.h>
+#endif
+
+#if defined(CO_SHM_USE_LZ4)
+#include <lz4.h>
+#endif
+
+#include "SharedDataDerivedSample.hpp"
+
+namespace co
+{
+namespace shm
+{
+
+// Magic number of the description sent to a new subscriber
+const uint32_t kSharedBridgeMagic = 0x47445242; // "BRDG"
+// Version of the protocol
+const uint32_t kSharedBridgeVersion = 1;
+// Magic number of a batch of records
+const uint32_t kSharedBridgeBatchMagic = 0x48435442; // "BTCH"
+// Maximum number of records in a batch (bits of the valid mask)
+const size_t kSharedBridgeMaxBatch = 64;
+// Flag of a record with the payload compressed (LZ4)
+const uint32_t kSharedBridgeCompressed = 1;
+// Amount of ms to wait for a notification before to accept subscribers
+const int kSharedBridgeWaitTimeout = 100;
+// Amount of ms a subscriber has to receive a batch before it is dropped
+const int kSharedBridgeSendTimeout = 50;
+// Maximum size of a string received (name, layout, text of an object)
+const uint64_t kSharedBridgeMaxString = 1 << 20;
+// Maximum number of int or double values of an object received
+const uint64_t kSharedBridgeMaxValues = 1 << 20;
+
+/** @brief Header of a record sent by the bridge. It is followed by the int
+           and double vectors, the string and the payload.
+*/
+struct SharedBridgeRecordHeader
+{
+	uint64_t id;
+	uint64_t sequence;
+	uint64_t timestamp_ns;
+	uint64_t num_int;
+	uint64_t num_double;
+	uint64_t text_bytes;
+	/** @brief Bytes of the payload sent
+	*/
+	uint64_t payload_bytes;
+	/** @brief Bytes of the payload (decompressed)
+	*/
+	uint64_t raw_bytes;
+	uint32_t flags;
+	uint32_t reserved;
+};
+
+/** @brief Header of a batch of records. The records are followed by a
+           64 bits mask of the valid records (bit i for the record i).
+*/
+struct SharedBridgeBatchHeader
+{
+	uint32_t magic;
+	uint32_t num_records;
+};
+
+#if defined(__unix__)
+
+/** @brief Stream sockets used by the bridge.
+
+	An address is "unix:<path>" for a Unix socket, or "<host>:<port>" for
+	TCP (an empty host listens on all the interfaces).
+*/
+class SharedSocket
+{
+public:
+
+	/** @brief It creates a socket that listens on an address
+	*/
+	static int listen(const std::string &address) {
+		int fd = -1;
+		if (is_unix(address)) {
+			sockaddr_un addr;
+			if (!unix_address(address, addr)) return -1;
+			unlink(addr.sun_path);
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd >= 0 && bind(fd, reinterpret_cast<sockaddr*>(&addr),
+				sizeof(addr)) != 0) {
+				close(fd);
+				fd = -1;
+			}
+		} else {
+			addrinfo *res = resolve(address, true);
+			if (res == nullptr) return -1;
+			fd = socket(res->ai_family, SOCK_STREAM, 0);
+			int on = 1;
+			if (fd >= 0) {
+				setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+			}
+			if (fd >= 0 && bind(fd, res->ai_addr, res->ai_addrlen) != 0) {
+				close(fd);
+				fd = -1;
+			}
+			freeaddrinfo(res);
+		}
+		if (fd >= 0 && ::listen(fd, SOMAXCONN) != 0) {
+			close(fd);
+			fd = -1;
+		}
+		if (fd < 0) std::cout << "Unable to listen on: " << address << std::endl;
+		return fd;
+	}
+
+	/** @brief It connects to an address
+	*/
+	static int connect(const std::string &address) {
+		int fd = -1;
+		if (is_unix(address)) {
+			sockaddr_un addr;
+			if (!unix_address(address, addr)) return -1;
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr),
+				sizeof(addr)) != 0) {
+				close(fd);
+				fd = -1;
+			}
+		} else {
+			addrinfo *res = resolve(address, false);
+			if (res == nullptr) return -1;
+			fd = socket(res->ai_family, SOCK_STREAM, 0);
+			if (fd >= 0 && ::connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+				close(fd);
+				fd = -1;
+			}
+			freeaddrinfo(res);
+			set_no_delay(fd);
+		}
+		if (fd < 0) std::cout << "Unable to connect to: " << address << std::endl;
+		return fd;
+	}
+
+	/** @brief It accepts a connection if one is pending (it does not block)
+	*/
+	static int accept(int listen_fd) {
+		pollfd p;
+		p.fd = listen_fd;
+		p.events = POLLIN;
+		p.revents = 0;
+		if (poll(&p, 1, 0) <= 0 || !(p.revents & POLLIN)) return -1;
+		int fd = ::accept(listen_fd, nullptr, nullptr);
+		set_no_delay(fd);
+		return fd;
+	}
+
+	/** @brief It sends a list of buffers (gather), with as few system calls
+	           as possible.
+
+		The buffers are not copied. The array is modified.
+	*/
+	static bool send_all(int fd, iovec *iov, size_t count) {
+		while (count > 0) {
+			if (!send_some(fd, iov, count, 0)) return false;
+		}
+		return true;
+	}
+
+	/** @brief It sends what the socket accepts without blocking, and it
+	           moves iov and count past the bytes sent.
+
+		@return It returns false if the connection failed.
+	*/
+	static bool send_some(int fd, iovec* &iov, size_t &count,
+		int flags = MSG_DONTWAIT) {
+		while (count > 0) {
+			msghdr msg;
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = iov;
+			msg.msg_iovlen = (std::min)(count, static_cast<size_t>(IOV_MAX));
+			ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL | flags);
+			if (sent < 0) {
+				if (errno == EINTR) continue;
+				return errno == EAGAIN || errno == EWOULDBLOCK;
+			}
+			// skip the buffers sent
+			size_t n = static_cast<size_t>(sent);
+			while (count > 0 && n >= iov->iov_len) {
+				n -= iov->iov_len;
+				++iov;
+				--count;
+			}
+			if (count > 0) {
+				iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+				iov->iov_len -= n;
+			}
+			if (flags == 0) return true;
+		}
+		return true;
+	}
+
+	/** @brief It receives exactly bytes
+	*/
+	static bool recv_all(int fd, void *data, size_t bytes) {
+		char *p = static_cast<char*>(data);
+		while (bytes > 0) {
+			ssize_t n = recv(fd, p, bytes, 0);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) return false;
+			p += n;
+			bytes -= static_cast<size_t>(n);
+		}
+		return true;
+	}
+
+private:
+
+	static bool is_unix(const std::string &address) {
+		return address.compare(0, 5, "unix:") == 0;
+	}
+
+	static bool unix_address(const std::string &address, sockaddr_un &addr) {
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		std::string path = address.substr(5);
+		if (path.empty() || path.size() >= sizeof(addr.sun_path)) return false;
+		memcpy(addr.sun_path, path.c_str(), path.size());
+		return true;
+	}
+
+	static addrinfo* resolve(const std::string &address, bool passive) {
+		size_t colon = address.rfind(':');
+		if (colon == std::string::npos) return nullptr;
+		std::string host = address.substr(0, colon);
+		std::string port = address.substr(colon + 1);
+		addrinfo hints;
+		memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		if (passive) hints.ai_flags = AI_PASSIVE;
+		addrinfo *res = nullptr;
+		if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(),
+			&hints, &res) != 0) {
+			return nullptr;
+		}
+		return res;
+	}
+
+	static void set_no_delay(int fd) {
+		if (fd < 0) return;
+		int on = 1;
+		// it fails (and it is not necessary) on a Unix socket
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	}
+};
+
+/** @brief It forwards the objects of a shared memory to the subscribers
+           connected to a socket.
+
+	It waits for the notifications of the memory, and it sends all the
+	objects published since the previous batch with a single sendmsg per
+	subscriber. The raw memory is sent straight from the shared memory:
+	a single buffered object is pinned by a read lease while it is sent
+	(its producer cannot write it), a triple buffered image sends its last
+	frame and the record is discarded by the subscribers if a new frame
+	was published in the meantime. The sockets are written without
+	blocking, and a subscriber that does not receive a batch within
+	kSharedBridgeSendTimeout ms is disconnected, so the memory is never
+	pinned longer than that.
+	i.e.
+	  SharedBridgeServer bridge;
+	  bridge.open("shm", "SharedObject", ":5000", { "rgb", "depth" },
+	    { "depth" });
+	  bridge.run();
+*/
+class SharedBridgeServer
+{
+public:
+
+	SharedBridgeServer() : global_seq_(nullptr), listen_fd_(-1),
+		do_continue_(false) {}
+
+	~SharedBridgeServer() {
+		for (auto fd : subscribers_) close(fd);
+		if (listen_fd_ >= 0) close(listen_fd_);
+	}
+
+	/** @brief It attaches to the memory and listens for the subscribers.
+
+		@param[in] objects Names of the objects to forward (empty: all).
+		@param[in] compressed Names of the objects compressed with LZ4
+		           (i.e. depth). They are sent uncompressed if the library
+		           is built without CO_SHM_USE_LZ4.
+	*/
+	bool open(const std::string &name_shm, const std::string &name_object,
+		const std::string &address, const std::vector<std::string> &objects,
+		const std::vector<std::string> &compressed) {
+		if (!shared_data_.detect(name_shm, name_object)) return false;
+		name_object_ = name_object;
+		// the memory is only detected: nothing is created in it
+		char_string *layout = shared_data_.smm().find_string("layout");
+		layout_ = layout != nullptr ? layout->c_str() : "";
+		if (layout_.empty()) {
+			std::cout << "The memory has no layout: " << name_shm << std::endl;
+			return false;
+		}
+		global_seq_ = shared_data_.smm().find_counter("global_seq");
+		if (global_seq_ == nullptr) {
+			std::cout << "The memory has no global sequence: " << name_shm <<
+				std::endl;
+			return false;
+		}
+		which_.clear();
+		for (size_t i = 0; i < shared_data_.smm().num_items(); ++i) {
+			if (objects.empty() && shared_data_.tap_supported(i)) {
+				which_.push_back(i);
+			}
+		}
+		for (auto &name : objects) {
+			size_t id = shared_data_.get_key_id(name);
+			if (id == kInvalidKeyID || !shared_data_.tap_supported(id)) {
+				std::cout << "Object not forwarded: " << name << std::endl;
+				continue;
+			}
+			which_.push_back(id);
+		}
+		is_compressed_.assign(which_.size(), false);
+		for (auto &name : compressed) {
+			size_t id = shared_data_.get_key_id(name);
+			auto it = std::find(which_.begin(), which_.end(), id);
+			if (it != which_.end()) is_compressed_[it - which_.begin()] = true;
+		}
+#if !defined(CO_SHM_USE_LZ4)
+		if (!compressed.empty()) {
+			std::cout << "LZ4 not available (CO_SHM_USE_LZ4): the objects " <<
+				"are sent uncompressed" << std::endl;
+		}
+#endif
+		last_sent_.assign(which_.size(), 0);
+		listen_fd_ = SharedSocket::listen(address);
+		return listen_fd_ >= 0;
+	}
+
+	/** @brief It forwards the objects until stop is called
+	*/
+	void run() {
+		if (global_seq_ == nullptr) return;
+		uint32_t last = SharedNotifier::load(global_seq_);
+		do_continue_ = true;
+		while (do_continue_) {
+			accept_subscribers();
+			SharedNotifier::wait(global_seq_, last, kSharedBridgeWaitTimeout);
+			if (!subscribers_.empty()) forward();
+		}
+	}
+
+	/** @brief It stops run
+	*/
+	void stop() {
+		do_continue_ = false;
+	}
+
+	/** @brief Number of connected subscribers
+	*/
+	size_t num_subscribers() const {
+		return subscribers_.size();
+	}
+
+private:
+
+	/** @brief It accepts the new subscribers and sends them the description
+	           of the memory.
+	*/
+	void accept_subscribers() {
+		for (;;) {
+			int fd = SharedSocket::accept(listen_fd_);
+			if (fd < 0) return;
+			uint32_t magic = kSharedBridgeMagic;
+			uint32_t version = kSharedBridgeVersion;
+			uint64_t name_bytes = name_object_.size();
+			uint64_t layout_bytes = layout_.size();
+			iovec iov[6] = {
+				{ &magic, sizeof(magic) }, { &version, sizeof(version) },
+				{ &name_bytes, sizeof(name_bytes) },
+				{ const_cast<char*>(name_object_.data()), name_object_.size() },
+				{ &layout_bytes, sizeof(layout_bytes) },
+				{ const_cast<char*>(layout_.data()), layout_.size() } };
+			if (!SharedSocket::send_all(fd, iov, 6)) {
+				close(fd);
+				continue;
+			}
+			subscribers_.push_back(fd);
+			// the new subscriber receives the current state of all the objects
+			std::fill(last_sent_.begin(), last_sent_.end(), 0);
+		}
+	}
+
+	/** @brief It sends the objects published since the previous batch
+	*/
+	void forward() {
+		size_t next = 0;
+		while (next < which_.size() && !subscribers_.empty()) {
+			records_.resize(kSharedBridgeMaxBatch);
+			headers_.resize(kSharedBridgeMaxBatch);
+			compressed_.resize(kSharedBridgeMaxBatch);
+			iov_.clear();
+			batch_.magic = kSharedBridgeBatchMagic;
+			batch_.num_records = 0;
+			iov_.push_back({ &batch_, sizeof(batch_) });
+			std::vector<size_t> index;
+			for (; next < which_.size() && index.size() < kSharedBridgeMaxBatch;
+				++next) {
+				SharedObjectHeader header;
+				if (!shared_data_.object_header(which_[next], header) ||
+					header.sequence == last_sent_[next]) {
+					continue;
+				}
+				size_t n = index.size();
+				const void *data = nullptr;
+				size_t bytes = 0;
+				if (!shared_data_.tap_acquire(which_[next], records_[n], data,
+					bytes)) {
+					// a writer holds it: it will notify again
+					continue;
+				}
+				add_record(n, data, bytes, is_compressed_[next]);
+				index.push_back(next);
+			}
+			if (index.empty()) continue;
+			batch_.num_records = static_cast<uint32_t>(index.size());
+			send(iov_);
+
+			// records whose memory did not change during the send
+			uint64_t valid = 0;
+			for (size_t n = 0; n < index.size(); ++n) {
+				if (shared_data_.tap_release(records_[n])) {
+					valid |= static_cast<uint64_t>(1) << n;
+					last_sent_[index[n]] = records_[n].sequence;
+				}
+			}
+			std::vector<iovec> trailer(1, iovec{ &valid, sizeof(valid) });
+			send(trailer);
+		}
+	}
+
+	/** @brief It adds the buffers of a record to the batch
+	*/
+	void add_record(size_t n, const void *data, size_t bytes,
+		bool do_compress) {
+		SharedTapRecord &record = records_[n];
+		SharedBridgeRecordHeader &header = headers_[n];
+		memset(&header, 0, sizeof(header));
+		header.id = record.id;
+		header.sequence = record.sequence;
+		header.timestamp_ns = record.timestamp_ns;
+		header.num_int = record.int_values.size();
+		header.num_double = record.double_values.size();
+		header.text_bytes = record.text.size();
+		header.payload_bytes = bytes;
+		header.raw_bytes = bytes;
+#if defined(CO_SHM_USE_LZ4)
+		if (do_compress && bytes > 0 && bytes <= LZ4_MAX_INPUT_SIZE) {
+			std::vector<char> &dst = compressed_[n];
+			dst.resize(LZ4_compressBound(static_cast<int>(bytes)));
+			int size = LZ4_compress_default(static_cast<const char*>(data),
+				dst.data(), static_cast<int>(bytes),
+				static_cast<int>(dst.size()));
+			if (size > 0 && static_cast<size_t>(size) < bytes) {
+				header.flags |= kSharedBridgeCompressed;
+				header.payload_bytes = size;
+				data = dst.data();
+			}
+		}
+#else
+		(void)do_compress;
+#endif
+		iov_.push_back({ &header, sizeof(header) });
+		iov_.push_back({ record.int_values.data(),
+			record.int_values.size() * sizeof(int) });
+		iov_.push_back({ record.double_values.data(),
+			record.double_values.size() * sizeof(double) });
+		iov_.push_back({ const_cast<char*>(record.text.data()),
+			record.text.size() });
+		iov_.push_back({ const_cast<void*>(data),
+			static_cast<size_t>(header.payload_bytes) });
+	}
+
+	/** @brief It sends the buffers to all the subscribers at the same
+	           time, without blocking on any of them.
+
+		A subscriber that has not received all the buffers within
+		kSharedBridgeSendTimeout is disconnected, so a slow subscriber
+		neither delays the others nor pins the memory of the objects.
+	*/
+	void send(const std::vector<iovec> &iov) {
+		size_t num = subscribers_.size();
+		iov_send_.resize(num);
+		std::vector<iovec*> next(num);
+		std::vector<size_t> count(num);
+		for (size_t i = 0; i < num; ++i) {
+			// send_some modifies the array
+			iov_send_[i] = iov;
+			next[i] = iov_send_[i].data();
+			count[i] = iov_send_[i].size();
+		}
+		std::vector<bool> is_dropped(num, false);
+		auto deadline = std::chrono::steady_clock::now() +
+			std::chrono::milliseconds(kSharedBridgeSendTimeout);
+		std::vector<pollfd> pending;
+		for (;;) {
+			pending.clear();
+			for (size_t i = 0; i < num; ++i) {
+				if (is_dropped[i] || count[i] == 0) continue;
+				if (!SharedSocket::send_some(subscribers_[i], next[i],
+					count[i])) {
+					is_dropped[i] = true;
+				} else if (count[i] > 0) {
+					pollfd p;
+					p.fd = subscribers_[i];
+					p.events = POLLOUT;
+					p.revents = 0;
+					pending.push_back(p);
+				}
+			}
+			if (pending.empty()) break;
+			int timeout_ms = static_cast<int>(
+				std::chrono::duration_cast<std::chrono::milliseconds>(
+				deadline - std::chrono::steady_clock::now()).count());
+			if (timeout_ms <= 0) {
+				// too slow: the stream cannot be resumed
+				for (size_t i = 0; i < num; ++i) {
+					if (count[i] > 0) is_dropped[i] = true;
+				}
+				break;
+			}
+			poll(pending.data(), pending.size(), timeout_ms);
+		}
+		for (size_t i = num; i-- > 0;) {
+			if (!is_dropped[i]) continue;
+			std::cout << "Subscriber disconnected" << std::endl;
+			close(subscribers_[i]);
+			subscribers_.erase(subscribers_.begin() + i);
+		}
+	}
+
+	/** @brief Memory attached
+	*/
+	SharedDataDerivedSample shared_data_;
+	std::string name_object_;
+	std::string layout_;
+	/** @brief Counter of the publications of the memory (global_seq)
+	*/
+	std::atomic<uint32_t> *global_seq_;
+	/** @brief Objects forwarded, and if they are compressed
+	*/
+	std::vector<size_t> which_;
+	std::vector<bool> is_compressed_;
+	/** @brief Sequence of the last publication sent of each object
+	*/
+	std::vector<uint64_t> last_sent_;
+	/** @brief Sockets
+	*/
+	int listen_fd_;
+	std::vector<int> subscribers_;
+	/** @brief Buffers of the batch (reused)
+	*/
+	SharedBridgeBatchHeader batch_;
+	std::vector<SharedTapRecord> records_;
+	std::vector<SharedBridgeRecordHeader> headers_;
+	std::vector<std::vector<char> > compressed_;
+	std::vector<iovec> iov_;
+	std::vector<std::vector<iovec> > iov_send_;
+	std::atomic<bool> do_continue_;
+};
+
+/** @brief It receives the objects forwarded by a SharedBridgeServer and
+           publishes them in a local memory with the same layout.
+*/
+class SharedBridgeClient
+{
+public:
+
+	SharedBridgeClient() : fd_(-1) {}
+
+	~SharedBridgeClient() {
+		if (fd_ >= 0) close(fd_);
+	}
+
+	/** @brief It connects to a bridge and creates the local memory
+	*/
+	bool open(const std::string &address, const std::string &name_shm) {
+		fd_ = SharedSocket::connect(address);
+		if (fd_ < 0) return false;
+		uint32_t magic = 0, version = 0;
+		std::string name_object, layout;
+		if (!SharedSocket::recv_all(fd_, &magic, sizeof(magic)) ||
+			!SharedSocket::recv_all(fd_, &version, sizeof(version)) ||
+			magic != kSharedBridgeMagic || version != kSharedBridgeVersion ||
+			!recv_string(name_object) || !recv_string(layout)) {
+			std::cout << "Invalid bridge: " << address << std::endl;
+			return false;
+		}
+		if (shared_data_.parse(name_shm, name_object, layout) !=
+			kSharedNoError) {
+			return false;
+		}
+		last_sequence_.assign(shared_data_.smm().num_items(), 0);
+		return true;
+	}
+
+	/** @brief It receives and publishes the objects until the bridge is
+	           disconnected (or stop is called).
+	*/
+	void run() {
+		std::vector<SharedTapRecord> records;
+		for (;;) {
+			SharedBridgeBatchHeader batch;
+			if (!SharedSocket::recv_all(fd_, &batch, sizeof(batch)) ||
+				batch.magic != kSharedBridgeBatchMagic ||
+				batch.num_records > kSharedBridgeMaxBatch) {
+				break;
+			}
+			records.resize(batch.num_records);
+			bool ok = true;
+			for (size_t n = 0; n < batch.num_records && ok; ++n) {
+				ok = recv_record(records[n]);
+			}
+			uint64_t valid = 0;
+			if (!ok || !SharedSocket::recv_all(fd_, &valid, sizeof(valid))) {
+				break;
+			}
+			for (size_t n = 0; n < batch.num_records; ++n) {
+				size_t id = static_cast<size_t>(records[n].id);
+				if (!((valid >> n) & 1) || id >= last_sequence_.size() ||
+					records[n].sequence == last_sequence_[id]) {
+					continue;
+				}
+				last_sequence_[id] = records[n].sequence;
+				shared_data_.tap_publish(records[n]);
+			}
+		}
+		std::cout << "Bridge disconnected" << std::endl;
+	}
+
+	/** @brief It stops run (from another thread)
+	*/
+	void stop() {
+		if (fd_ >= 0) shutdown(fd_, SHUT_RDWR);
+	}
+
+	/** @brief Local memory
+	*/
+	SharedDataDerivedSample& shared_data() {
+		return shared_data_;
+	}
+
+private:
+
+	bool recv_string(std::string &s) {
+		uint64_t size = 0;
+		if (!SharedSocket::recv_all(fd_, &size, sizeof(size)) ||
+			size > kSharedBridgeMaxString) {
+			return false;
+		}
+		s.resize(size);
+		return SharedSocket::recv_all(fd_, &s[0], size);
+	}
+
+	/** @brief It returns true if the sizes of a record fit the local
+	           object, so a corrupted stream cannot allocate without bound.
+	*/
+	bool is_valid(const SharedBridgeRecordHeader &header) {
+		SharedObject *obj = header.id < last_sequence_.size() ?
+			shared_data_.smm().shared_object(static_cast<size_t>(header.id)) :
+			nullptr;
+		if (obj == nullptr || header.num_int > kSharedBridgeMaxValues ||
+			header.num_double > kSharedBridgeMaxValues ||
+			header.text_bytes > kSharedBridgeMaxString ||
+			header.raw_bytes > obj->ptr_size()) {
+			std::cout << "Invalid record of the object " << header.id <<
+				std::endl;
+			return false;
+		}
+		if (!(header.flags & kSharedBridgeCompressed)) {
+			return header.payload_bytes == header.raw_bytes;
+		}
+		// the compressed size is at most raw + raw / 255 + 16 (LZ4)
+		return header.payload_bytes <=
+			header.raw_bytes + header.raw_bytes / 255 + 16;
+	}
+
+	/** @brief It receives a record
+	*/
+	bool recv_record(SharedTapRecord &record) {
+		SharedBridgeRecordHeader header;
+		if (!SharedSocket::recv_all(fd_, &header, sizeof(header)) ||
+			!is_valid(header)) {
+			return false;
+		}
+		record.id = header.id;
+		record.sequence = header.sequence;
+		record.timestamp_ns = header.timestamp_ns;
+		record.int_values.resize(header.num_int);
+		record.double_values.resize(header.num_double);
+		record.text.resize(header.text_bytes);
+		record.payload.resize(header.raw_bytes);
+		if (!SharedSocket::recv_all(fd_, record.int_values.data(),
+			header.num_int * sizeof(int)) ||
+			!SharedSocket::recv_all(fd_, record.double_values.data(),
+			header.num_double * sizeof(double)) ||
+			!SharedSocket::recv_all(fd_, &record.text[0], header.text_bytes)) {
+			return false;
+		}
+		if (!(header.flags & kSharedBridgeCompressed)) {
+			return SharedSocket::recv_all(fd_, record.payload.data(),
+				header.payload_bytes);
+		}
+#if defined(CO_SHM_USE_LZ4)
+		compressed_.resize(header.payload_bytes);
+		return SharedSocket::recv_all(fd_, compressed_.data(),
+			header.payload_bytes) &&
+			LZ4_decompress_safe(compressed_.data(), record.payload.data(),
+			static_cast<int>(header.payload_bytes),
+			static_cast<int>(header.raw_bytes)) ==
+			static_cast<int>(header.raw_bytes);
+#else
+		std::cout << "LZ4 not available (CO_SHM_USE_LZ4)" << std::endl;
+		return false;
+#endif
+	}
+
+	SharedDataDerivedSample shared_data_;
+	/** @brief Sequence of the last record published of each object
+	*/
+	std::vector<uint64_t> last_sequence_;
+	int fd_;
+	std::vector<char> compressed_;
+};
+
+#endif // __unix__
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDBRIDGE_HPP__
@@ -0,0 +1,444 @@
+/**
+* @file SharedBroadcastRing.hpp
+* @brief Single producer/multiple consumers ring with a cursor for each reader.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDBROADCASTRING_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDBROADCASTRING_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include "SharedFrameRing.hpp"
+
+namespace co
+{
+namespace shm
+{
+
+// Magic number written in an initialized broadcast ring header
+const uint32_t kSharedBroadcastRingMagic = 0x42524f44; // "BROD"
+
+// When the slowest reader is num_slots behind the producer...
+// ... the oldest frame is overwritten (the reader loses it)
+const uint32_t kBroadcastOverwrite = 0;
+// ... the new frame is refused (backpressure). A reader that dies without
+// detaching would block the producer forever: each cursor stores the pid of
+// its reader, and publish (when it is refused) and attach (when all the
+// cursors are used) reclaim the cursors of the processes that are gone
+// (see SharedBroadcastRing::recover_readers). The readers and the producer
+// must share the pid namespace.
+const uint32_t kBroadcastBlock = 1;
+
+// State of a reader cursor
+const uint32_t kBroadcastReaderFree = 0;
+const uint32_t kBroadcastReaderAttaching = 1;
+const uint32_t kBroadcastReaderActive = 2;
+
+// Invalid reader index
+const int kBroadcastInvalidReader = -1;
+
+/** @brief Header of the broadcast ring. It lives at the beginning of the raw
+           memory of the shared object, followed by the reader cursors and
+           the slots.
+*/
+struct SharedBroadcastRingHeader
+{
+	/** @brief Number of frames published (next sequence to write)
+	*/
+	std::atomic<uint64_t> write_seq;
+	char pad_write[kSharedCacheLineBytes - sizeof(std::atomic<uint64_t>)];
+	uint32_t magic;
+	uint32_t mode;
+	uint64_t slot_bytes;
+	uint64_t num_slots;
+	uint64_t slot_stride;
+	uint64_t max_readers;
+	char pad_info[kSharedCacheLineBytes - 5 * sizeof(uint64_t)];
+};
+
+/** @brief Cursor of a reader (one cache line each)
+*/
+struct SharedBroadcastReader
+{
+	std::atomic<uint32_t> state;
+	/** @brief Process of the reader (0 while attaching or free)
+	*/
+	std::atomic<uint32_t> pid;
+	/** @brief Next sequence to read
+	*/
+	std::atomic<uint64_t> cursor;
+	char pad[kSharedCacheLineBytes - 2 * sizeof(uint64_t)];
+};
+
+/** @brief Header of a slot. The payload follows the header.
+*/
+struct SharedBroadcastSlot
+{
+	/** @brief 2 * sequence + 1 while written, 2 * sequence + 2 when complete
+	*/
+	std::atomic<uint64_t> stamp;
+	uint64_t bytes;
+	char pad[kSharedCacheLineBytes - 2 * sizeof(uint64_t)];
+};
+
+/** @brief View over a broadcast ring allocated in the shared memory.
+
+	One producer publishes frames that every attached reader receives, each
+	one at its own pace through its own cursor. The producer sees the
+	slowest cursor and, depending on the mode, refuses new frames or
+	overwrites the oldest ones. A reader that is overwritten skips the lost
+	frames and never returns torn data.
+*/
+class SharedBroadcastRing
+{
+public:
+
+	SharedBroadcastRing() : header_(nullptr) {}
+
+	explicit SharedBroadcastRing(void *ptr) :
+		header_(static_cast<SharedBroadcastRingHeader*>(ptr)) {}
+
+	/** @brief It returns the bytes necessary to allocate a ring.
+	*/
+	static constexpr size_t memory_size(size_t slot_bytes, size_t num_slots,
+		size_t max_readers) {
+		return sizeof(SharedBroadcastRingHeader) +
+			max_readers * sizeof(SharedBroadcastReader) +
+			num_slots * slot_stride(slot_bytes);
+	}
+
+	/** @brief It returns the distance in bytes between two slots.
+	*/
+	static constexpr size_t slot_stride(size_t slot_bytes) {
+		return (sizeof(SharedBroadcastSlot) + slot_bytes +
+			kSharedCacheLineBytes - 1) /
+			kSharedCacheLineBytes * kSharedCacheLineBytes;
+	}
+
+	/** @brief It initializes the ring. It must be called only once by the
+	           process that allocates the memory.
+	*/
+	void initialize(size_t slot_bytes, size_t num_slots, size_t max_readers,
+		uint32_t mode) {
+		if (header_ == nullptr) return;
+		new (&header_->write_seq) std::atomic<uint64_t>(0);
+		header_->mode = mode;
+		header_->slot_bytes = slot_bytes;
+		header_->num_slots = num_slots;
+		header_->slot_stride = slot_stride(slot_bytes);
+		header_->max_readers = max_readers;
+		for (size_t i = 0; i < max_readers; ++i) {
+			new (&reader(i).state) std::atomic<uint32_t>(kBroadcastReaderFree);
+			new (&reader(i).pid) std::atomic<uint32_t>(0);
+			new (&reader(i).cursor) std::atomic<uint64_t>(0);
+		}
+		for (size_t i = 0; i < num_slots; ++i) {
+			new (&slot(i)->stamp) std::atomic<uint64_t>(0);
+			slot(i)->bytes = 0;
+		}
+		header_->magic = kSharedBroadcastRingMagic;
+	}
+
+	/** @brief It returns true if the memory contains an initialized ring.
+	*/
+	bool is_valid() const {
+		return header_ != nullptr &&
+			header_->magic == kSharedBroadcastRingMagic &&
+			header_->num_slots > 0;
+	}
+
+	/** @brief Maximum size of a frame (bytes)
+	*/
+	size_t slot_bytes() const {
+		return is_valid() ? static_cast<size_t>(header_->slot_bytes) : 0;
+	}
+
+	/** @brief Number of frames published
+	*/
+	uint64_t write_sequence() const {
+		return is_valid() ? header_->write_seq.load(std::memory_order_acquire) : 0;
+	}
+
+	/** @brief Reader. It attaches a new reader. It starts from the next
+	           published frame.
+
+		If all the cursors are used, the cursors of the dead readers are
+		reclaimed and the attach is tried again.
+		@return The reader index or kBroadcastInvalidReader if all the
+		        cursors are used.
+	*/
+	int attach() {
+		if (!is_valid()) return kBroadcastInvalidReader;
+		int reader_id = try_attach();
+		if (reader_id == kBroadcastInvalidReader && recover_readers() > 0) {
+			reader_id = try_attach();
+		}
+		return reader_id;
+	}
+
+	/** @brief Reader. It detaches a reader. Its cursor no more holds back
+	           the producer.
+	*/
+	void detach(int reader_id) {
+		if (!is_reader(reader_id)) return;
+		reader(reader_id).pid.store(0, std::memory_order_relaxed);
+		reader(reader_id).state.store(kBroadcastReaderFree,
+			std::memory_order_release);
+	}
+
+	/** @brief It frees the cursors of the readers whose process is gone
+	           (crashed or killed without detaching).
+
+		A pid reused by a new process keeps the cursor until that process
+		exits. On the platforms without a process check nothing is freed.
+		@return Number of cursors freed.
+	*/
+	size_t recover_readers() {
+		if (!is_valid()) return 0;
+		size_t freed = 0;
+		for (size_t i = 0; i < header_->max_readers; ++i) {
+			SharedBroadcastReader &r = reader(i);
+			uint32_t expected = kBroadcastReaderActive;
+			if (r.state.load(std::memory_order_acquire) != expected) continue;
+			uint32_t pid = r.pid.load(std::memory_order_acquire);
+			if (pid == 0 || process_alive(pid)) continue;
+			// claim the cursor, so a reader that attaches in the meantime
+			// is not freed
+			if (!r.state.compare_exchange_strong(expected,
+				kBroadcastReaderAttaching, std::memory_order_acq_rel)) {
+				continue;
+			}
+			if (r.pid.load(std::memory_order_acquire) != pid) {
+				r.state.store(kBroadcastReaderActive, std::memory_order_release);
+				continue;
+			}
+			r.pid.store(0, std::memory_order_relaxed);
+			r.state.store(kBroadcastReaderFree, std::memory_order_release);
+			++freed;
+		}
+		return freed;
+	}
+
+	/** @brief Producer. Sequence of the slowest attached reader.
+
+		It is equal to write_sequence() if there are no readers.
+	*/
+	uint64_t slowest_cursor() const {
+		uint64_t w = write_sequence();
+		uint64_t slowest = w;
+		for (size_t i = 0; i < header_->max_readers; ++i) {
+			if (reader(i).state.load(std::memory_order_acquire) !=
+				kBroadcastReaderActive) continue;
+			uint64_t c = reader(i).cursor.load(std::memory_order_acquire);
+			if (c < slowest) slowest = c;
+		}
+		return slowest;
+	}
+
+	/** @brief Producer. It publishes a frame to all the readers.
+
+		In kBroadcastBlock mode a refused frame first reclaims the cursors
+		of the dead readers (see recover_readers).
+		@return It returns false if the frame is too large or, in
+		        kBroadcastBlock mode, the slowest reader is num_slots behind.
+	*/
+	bool publish(const void *data, size_t bytes) {
+		if (!is_valid() || bytes > header_->slot_bytes) return false;
+		uint64_t s = header_->write_seq.load(std::memory_order_relaxed);
+		if (header_->mode == kBroadcastBlock &&
+			s - slowest_cursor() >= header_->num_slots &&
+			(recover_readers() == 0 ||
+			s - slowest_cursor() >= header_->num_slots)) {
+			return false;
+		}
+		SharedBroadcastSlot *sl = slot(s % header_->num_slots);
+		sl->stamp.store(2 * s + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(reinterpret_cast<char*>(sl) + sizeof(SharedBroadcastSlot),
+			data, bytes);
+		sl->bytes = bytes;
+		sl->stamp.store(2 * s + 2, std::memory_order_release);
+		header_->write_seq.store(s + 1, std::memory_order_release);
+		return true;
+	}
+
+	/** @brief Reader. It copies the next frame for the reader.
+
+		A frame larger than max_bytes is skipped and counted in lost, so the
+		reader does not stop on it (max_bytes should be slot_bytes()).
+		@param[out] bytes Number of bytes copied.
+		@param[out] lost Number of frames overwritten or skipped before
+		            being read.
+		@return It returns false if there is no new frame.
+	*/
+	bool read(int reader_id, void *data, size_t max_bytes, size_t &bytes,
+		uint64_t &lost) {
+		bytes = 0;
+		lost = 0;
+		if (!is_reader(reader_id)) return false;
+		SharedBroadcastReader &r = reader(reader_id);
+		uint64_t c = r.cursor.load(std::memory_order_relaxed);
+		for (;;) {
+			uint64_t w = header_->write_seq.load(std::memory_order_acquire);
+			if (c >= w) break;
+			// the producer overwrote the frames
+			if (w - c > header_->num_slots) {
+				lost += w - header_->num_slots - c;
+				c = w - header_->num_slots;
+			}
+			const SharedBroadcastSlot *sl = slot(c % header_->num_slots);
+			uint64_t stamp = sl->stamp.load(std::memory_order_acquire);
+			if (stamp != 2 * c + 2) {
+				// overwritten (or being overwritten) in the meantime
+				++lost;
+				++c;
+				continue;
+			}
+			size_t size = static_cast<size_t>(sl->bytes);
+			if (size > max_bytes) {
+				// it does not fit: skipped
+				++lost;
+				++c;
+				continue;
+			}
+			memcpy(data, reinterpret_cast<const char*>(sl) +
+				sizeof(SharedBroadcastSlot), size);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sl->stamp.load(std::memory_order_relaxed) != stamp) {
+				++lost;
+				++c;
+				continue;
+			}
+			bytes = size;
+			r.cursor.store(c + 1, std::memory_order_release);
+			return true;
+		}
+		r.cursor.store(c, std::memory_order_release);
+		return false;
+	}
+
+	/** @brief Reader. Number of frames published and not yet read.
+	*/
+	uint64_t lag(int reader_id) const {
+		if (!is_reader(reader_id)) return 0;
+		return write_sequence() -
+			reader(reader_id).cursor.load(std::memory_order_acquire);
+	}
+
+private:
+
+	/** @brief It takes a free cursor
+	*/
+	int try_attach() {
+		for (size_t i = 0; i < header_->max_readers; ++i) {
+			uint32_t expected = kBroadcastReaderFree;
+			if (reader(i).state.compare_exchange_strong(expected,
+				kBroadcastReaderAttaching, std::memory_order_acq_rel)) {
+				reader(i).cursor.store(
+					header_->write_seq.load(std::memory_order_acquire),
+					std::memory_order_relaxed);
+				reader(i).pid.store(current_pid(), std::memory_order_relaxed);
+				reader(i).state.store(kBroadcastReaderActive,
+					std::memory_order_release);
+				return static_cast<int>(i);
+			}
+		}
+		return kBroadcastInvalidReader;
+	}
+
+	/** @brief Pid of this process
+	*/
+	static uint32_t current_pid() {
+#if defined(__linux__)
+		return static_cast<uint32_t>(getpid());
+#elif defined(_WIN32)
+		return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+		return 0;
+#endif
+	}
+
+	/** @brief It returns true if the process exists (or it cannot be
+	           checked)
+	*/
+	static bool process_alive(uint32_t pid) {
+#if defined(__linux__)
+		// EPERM: it exists, but it belongs to another user
+		return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#elif defined(_WIN32)
+		HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE,
+			static_cast<DWORD>(pid));
+		if (process == NULL) return GetLastError() == ERROR_ACCESS_DENIED;
+		DWORD code = 0;
+		bool alive = GetExitCodeProcess(process, &code) != 0 &&
+			code == STILL_ACTIVE;
+		CloseHandle(process);
+		return alive;
+#else
+		(void)pid;
+		return true;
+#endif
+	}
+
+	/** @brief It returns true if the reader index is valid
+	*/
+	bool is_reader(int reader_id) const {
+		return is_valid() && reader_id >= 0 &&
+			static_cast<uint64_t>(reader_id) < header_->max_readers;
+	}
+
+	/** @brief Cursor of a reader
+	*/
+	SharedBroadcastReader& reader(size_t index) const {
+		return reinterpret_cast<SharedBroadcastReader*>(
+			reinterpret_cast<char*>(header_) +
+			sizeof(SharedBroadcastRingHeader))[index];
+	}
+
+	/** @brief It returns a slot given its index
+	*/
+	SharedBroadcastSlot* slot(uint64_t index) const {
+		return reinterpret_cast<SharedBroadcastSlot*>(
+			reinterpret_cast<char*>(header_) +
+			sizeof(SharedBroadcastRingHeader) +
+			header_->max_readers * sizeof(SharedBroadcastReader) +
+			index * header_->slot_stride);
+	}
+
+	/** @brief Header of the ring in the shared memory
+	*/
+	SharedBroadcastRingHeader *header_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDBROADCASTRING_HPP__
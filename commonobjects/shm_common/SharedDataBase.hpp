@@ -27,8 +27,16 @@
 #include <mutex>
 #include <condition_variable>
 #include <map>
+#include <thread>
+#include <functional>
 
 #include "doc_managedmemory_shared_data_base.hpp"
+#include "SharedFrameRing.hpp"
+#include "SharedBroadcastRing.hpp"
+#include "SharedFramePool.hpp"
+#include "SharedTripleBuffer.hpp"
+#include "SharedDirtyTiles.hpp"
+#include "SharedThreadPolicy.hpp"
 #include "../string_common/StringOp.hpp"
 
 namespace co
@@ -36,7 +44,7 @@ namespace co
 namespace shm
 {
 
-// Set the thread priority mode
+// Set the thread priority mode (see SharedDataBase::thread_priority_policy)
 const int kThreadPriorityNone = 0;
 const int kThreadPriorityLowest = 1;
 const int kThreadPriorityBelowNormal = 2;
@@ -55,10 +63,43 @@ const int kSharedUnableToCreateSharedMemory = 2;
 // Invalid ID when a key does not exist.
 const size_t kInvalidKeyID = -1;
 
+// Buffering of an image object (int_vector_[1])
+const int kImageBufferSingle = 0;
+const int kImageBufferTriple = 1;
+
+// Dirty tiles of an image object (int_vector_ after the buffering): side of
+// the tiles, number of dirty tiles and first word of the bitmap
+const size_t kImageDirtyTileSize = 2;
+const size_t kImageDirtyNumTiles = 3;
+const size_t kImageDirtyBitmap = 4;
+
+// Amount of ms to timeout the wait of an event loop
+const int kSharedEventLoopTimeout = 1000;
+
 /** @brief Function for callback
 */
 typedef std::function<void(size_t id, SharedMemoryManager &smm)> registration_callback_function_shared;
 
+/** @brief Handle to a shared object. It caches the result of a name lookup.
+*/
+struct SharedObjectHandle
+{
+	SharedObjectHandle() : id(kInvalidKeyID), object(nullptr) {}
+
+	/** @brief It returns true if the object exists
+	*/
+	bool is_valid() const {
+		return object != nullptr;
+	}
+
+	/** @brief Object id
+	*/
+	size_t id;
+	/** @brief Object in the shared memory
+	*/
+	SharedObject *object;
+};
+
 /** @brief Class to manage a shared data
 
 The shared objects contains the information of 3D cloud points
@@ -74,7 +115,9 @@ class SharedDataBase
 {
 public:
 
-	SharedDataBase() : /*c_is_ready_(false), */memory_to_allocate_bytes_(0) {}
+	SharedDataBase() : /*c_is_ready_(false), */memory_to_allocate_bytes_(0),
+		next_isolated_cpu_(0), notification_mode_(kNotificationCondition),
+		wait_spin_ns_(kSharedSpinNone), global_seq_(nullptr) {}
 
 	~SharedDataBase() {
 		stop();
@@ -100,16 +143,49 @@ public:
 	/** @brief It starts the worker
 	*/
 	void start(int thread_priority) {
-		t_process_ = std::thread(&SharedDataBase::process, this, thread_priority);
+		t_process_ = std::thread([this, thread_priority]() {
+			apply_thread_policy(kInvalidKeyID, thread_priority);
+			process(thread_priority);
+		});
 	}
 
 	/** @brief It starts a set of workers to listen for a specific process
 	*/
 	void start(std::vector<size_t> &which, int thread_priority) {
 		for (auto &it : which) {
+			size_t object_id = it;
 			container_t_process_.push_back(
-				std::thread(&SharedDataBase::process_id, this,
-					thread_priority, it));
+				std::thread([this, thread_priority, object_id]() {
+				apply_thread_policy(object_id, thread_priority);
+				process_id(thread_priority, object_id);
+			}));
+		}
+	}
+
+	/** @brief It starts an event loop to listen for a set of objects
+
+		num_threads threads (at least one) share the objects. Each thread
+		waits for any notification in the shared memory and calls the
+		callback for the objects notified since its last wake up. A thread
+		takes the policy and the affinity of its first object.
+	*/
+	void start_event_loop(std::vector<size_t> &which, int num_threads,
+		int thread_priority) {
+		if (num_threads < 1) num_threads = 1;
+		if (static_cast<size_t>(num_threads) > which.size()) {
+			num_threads = static_cast<int>(which.size());
+		}
+		for (int t = 0; t < num_threads; ++t) {
+			std::vector<size_t> which_thread;
+			for (size_t i = t; i < which.size(); i += num_threads) {
+				which_thread.push_back(which[i]);
+			}
+			if (which_thread.empty()) continue;
+			container_t_process_.push_back(
+				std::thread([this, thread_priority, which_thread]() {
+				apply_thread_policy(which_thread.front(), thread_priority);
+				process_events(thread_priority, which_thread);
+			}));
 		}
 	}
 
@@ -138,6 +214,67 @@ public:
 	*/
 	virtual void process_id(int thread_priority, size_t object_id) = 0;
 
+	/** @brief If started from the function "start_event_loop()" it will run
+	           in a separated thread.
+
+		It waits for the notification counter of the whole shared memory and
+		calls the callback for each object in which that has been notified.
+		No mutex is held while waiting or during the callback.
+	*/
+	virtual void process_events(int /*thread_priority*/, std::vector<size_t> which) {
+		if (global_seq_ == nullptr) return;
+		std::vector<uint32_t> last(which.size(), 0);
+		std::vector<uint64_t> last_write(which.size(), 0);
+		std::vector<SharedObject*> objs(which.size(), nullptr);
+		for (size_t i = 0; i < which.size(); ++i) {
+			objs[i] = smm_.shared_object(which[i]);
+			if (objs[i] != nullptr) {
+				last[i] = SharedNotifier::load(&objs[i]->notify_seq_);
+				last_write[i] = objs[i]->stats_.write_count.load(
+					std::memory_order_acquire);
+			}
+		}
+		uint32_t global_last = SharedNotifier::load(global_seq_);
+
+		do_continue_ = true;
+		do {
+			if (!SharedNotifier::wait(global_seq_, global_last, 
+				kSharedEventLoopTimeout, wait_spin_ns_)) {
+				continue;
+			}
+			// dispatch the objects that changed
+			for (size_t i = 0; i < which.size(); ++i) {
+				if (objs[i] == nullptr) continue;
+				uint32_t current = SharedNotifier::load(&objs[i]->notify_seq_);
+				if (current == last[i]) continue;
+				last[i] = current;
+				dispatch_callback(which[i], last_write[i]);
+			}
+		} while (do_continue_);
+	}
+
+	/** @brief It calls the callback for an object and updates the
+	           statistics of the object.
+
+		@param[in,out] last_write Number of writes of the object seen by the
+		               previous callback of the thread.
+	*/
+	void dispatch_callback(size_t object_id, uint64_t &last_write) {
+		if (f_callback_ == nullptr) return;
+		SharedObject *obj = smm_.shared_object(object_id);
+		if (obj == nullptr) {
+			f_callback_(object_id, smm_);
+			return;
+		}
+		uint64_t writes = obj->stats_.write_count.load(
+			std::memory_order_acquire);
+		uint64_t missed = writes > last_write + 1 ? writes - last_write - 1 : 0;
+		last_write = writes;
+		uint64_t begin = SharedObjectStats::now_ns();
+		f_callback_(object_id, smm_);
+		obj->stats_.record_callback(SharedObjectStats::now_ns() - begin, missed);
+	}
+
 	/** @brief It register the callback function
 	*/
 	void registerCallback(registration_callback_function_shared &&callback) {
@@ -145,21 +282,24 @@ public:
 	}
 
 	/** @brief It returns the index of an associated object key
+
+		It uses the hash table of the names saved in the shared memory.
 	*/
 	size_t get_key_id(const std::string &key) {
-		for (size_t i = 0; i < smm_.num_items(); ++i) {
-			if (smm_.shared_object(i) != nullptr) {
-				std::string s(smm_.shared_object(i)->object_name_.begin(),
-					smm_.shared_object(i)->object_name_.end());
-				if (s == key) {
-					return i;
-				}
-			}
-		}
-		//if (key_id_.find(key) != key_id_.end()) {
-		//	return key_id_[key];
-		//} 
-		return kInvalidKeyID;
+		size_t id = smm_.key_id(key);
+		if (id >= smm_.num_items()) return kInvalidKeyID;
+		return id;
+	}
+
+	/** @brief It returns a handle of an associated object key
+
+		The handle can be cached by the caller to avoid the name lookup.
+	*/
+	SharedObjectHandle get_handle(const std::string &key) {
+		SharedObjectHandle handle;
+		handle.id = get_key_id(key);
+		handle.object = smm_.shared_object(handle.id);
+		return handle;
 	}
 
 	/** @brief It notifies that the data has been pushed (process)
@@ -174,17 +314,74 @@ public:
 	/** @brief Notify for the objects allocated
 	*/
 	void notify_objects() {
-		for (auto &it : v_obj_cnd_) it->notify_all();
+		for (size_t i = 0; i < v_obj_cnd_.size(); ++i) notify_object(i);
 	}
 
 	/** @brief Notify for a single object allocated
+
+		The waiters of every backend are notified, since each process selects
+		its own notification mode.
 	*/
 	void notify_object(size_t id_obj) {
 		if (id_obj >= 0 && id_obj < v_obj_cnd_.size()) {
+			SharedObject *obj = smm_.shared_object(id_obj);
+			if (obj != nullptr) SharedNotifier::notify_all(&obj->notify_seq_);
+			// readiness of the event loops (after the object counter)
+			if (global_seq_ != nullptr) SharedNotifier::notify_all(global_seq_);
 			v_obj_cnd_[id_obj]->notify_all();
 		}
 	}
 
+	/** @brief It selects how this process waits for the objects in
+	           process_id (kNotificationCondition or kNotificationFutex).
+
+		It must be called before start.
+		@return It returns false if the mode is not supported.
+	*/
+	bool set_notification_mode(int mode) {
+		if (mode == kNotificationFutex && !SharedNotifier::is_futex_available()) {
+			return false;
+		}
+		notification_mode_ = mode;
+		return true;
+	}
+
+	/** @brief Current notification mode
+	*/
+	int notification_mode() const {
+		return notification_mode_;
+	}
+
+	/** @brief It waits for a notification of an object without any mutex.
+
+		@param[in,out] last Last notification counter observed.
+		@return It returns true if the object was notified, false on timeout.
+	*/
+	bool wait_object(size_t id_obj, uint32_t &last, int timeout_ms) {
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (obj == nullptr) return false;
+		return SharedNotifier::wait(&obj->notify_seq_, last, timeout_ms,
+			wait_spin_ns_);
+	}
+
+	/** @brief It sets how long a waiting thread polls the notification
+	           counter before blocking (ns, kSharedSpinNone to block
+	           immediately).
+
+		The polling reacts in a few microseconds, but it keeps a core busy:
+		use it for the consumers with a dedicated core (see
+		set_thread_policy). It must be called before start.
+	*/
+	void set_wait_spin(int64_t spin_ns) {
+		wait_spin_ns_ = spin_ns;
+	}
+
+	/** @brief Time of busy polling before blocking (ns)
+	*/
+	int64_t wait_spin() const {
+		return wait_spin_ns_;
+	}
+
 	/** @brief It returns the pointer to the object associated
 	*/
 	void* object_get_ptr(size_t id_obj, size_t &size) {
@@ -198,6 +395,195 @@ public:
 	//	return nullptr;
 	//}
 
+	/** @brief It returns a view of the ring associated to an object
+
+		The view is not valid (is_valid() == false) if the object is not a
+		ring.
+	*/
+	SharedFrameRing object_get_ring(size_t id_obj) {
+		size_t size = 0;
+		void *ptr = smm_.object_get_ptr(id_obj, size);
+		if (ptr == nullptr || size < sizeof(SharedFrameRingHeader)) {
+			return SharedFrameRing();
+		}
+		return SharedFrameRing(ptr);
+	}
+
+	/** @brief It changes the size of the raw memory of an object.
+
+		The new memory is allocated in the free memory of the segment (a
+		mapped segment does not grow, see SharedMemoryManager::grow).
+		The objects waiting for the object are notified.
+		@return It returns false if the memory is leased or not available.
+	*/
+	bool object_resize(size_t id_obj, size_t bytes) {
+		if (!smm_.object_reallocate(id_obj, bytes)) return false;
+		notify_object(id_obj);
+		return true;
+	}
+
+	/** @brief It returns a view of the broadcast ring associated to an object
+
+		The view is not valid (is_valid() == false) if the raw memory does
+		not contain an initialized broadcast ring.
+	*/
+	SharedBroadcastRing object_get_broadcast(size_t id_obj) {
+		size_t size = 0;
+		void *ptr = smm_.object_get_ptr(id_obj, size);
+		if (ptr == nullptr || size < sizeof(SharedBroadcastRingHeader)) {
+			return SharedBroadcastRing();
+		}
+		return SharedBroadcastRing(ptr);
+	}
+
+	/** @brief It returns a view of the frame pool associated to an object
+
+		The view is not valid (is_valid() == false) if the raw memory does
+		not contain an initialized frame pool.
+	*/
+	SharedFramePool object_get_pool(size_t id_obj) {
+		size_t size = 0;
+		void *ptr = smm_.object_get_ptr(id_obj, size);
+		if (ptr == nullptr || size < sizeof(SharedFramePoolHeader)) {
+			return SharedFramePool();
+		}
+		return SharedFramePool(ptr);
+	}
+
+	/** @brief It returns a view of the triple buffer associated to an object
+
+		The view is not valid (is_valid() == false) if the raw memory does
+		not contain an initialized triple buffer.
+	*/
+	SharedTripleBuffer object_get_triple_buffer(size_t id_obj) {
+		size_t size = 0;
+		void *ptr = smm_.object_get_ptr(id_obj, size);
+		if (ptr == nullptr || size < sizeof(SharedTripleBufferHeader)) {
+			return SharedTripleBuffer();
+		}
+		return SharedTripleBuffer(ptr);
+	}
+
+
+	/** @brief It acquires a read lease on the raw memory of an object.
+
+		The memory is not modified until object_release_read is called:
+		a single buffered object refuses the writers, a triple buffered image
+		pins its most recent frame (each lease pins its own frame, the writer
+		fills another buffer).
+		@param[out] bytes Size of the memory.
+		@return The memory or nullptr if a writer holds the object (or a
+		        triple buffered image has no frame yet).
+	*/
+	const void* object_acquire_read(size_t id_obj, size_t &bytes) {
+		bytes = 0;
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (obj == nullptr) return nullptr;
+		// the writer of a triple buffer fills a frame that is not pinned
+		uint32_t refused = is_triple_buffer(id_obj) ? kSharedLeaseResize :
+			kSharedLeaseWriter | kSharedLeaseResize;
+		uint32_t state = obj->lease_state_.load(std::memory_order_relaxed);
+		do {
+			if (state & refused) return nullptr;
+		} while (!obj->lease_state_.compare_exchange_weak(state, state + 1,
+			std::memory_order_acquire, std::memory_order_relaxed));
+
+		SharedTripleBuffer tb = image_triple_buffer(id_obj);
+		if (tb.is_valid()) {
+			const void *ptr = tb.acquire_read();
+			if (ptr == nullptr) {
+				obj->lease_state_.fetch_sub(1, std::memory_order_release);
+				return nullptr;
+			}
+			bytes = tb.buffer_bytes();
+			return ptr;
+		}
+		return smm_.object_get_ptr(id_obj, bytes);
+	}
+
+	/** @brief It releases a read lease.
+
+		@param[in] data Memory returned by object_acquire_read (it selects
+		           the frame of a triple buffered image).
+	*/
+	void object_release_read(size_t id_obj, const void *data) {
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (obj == nullptr) return;
+		SharedTripleBuffer tb = image_triple_buffer(id_obj);
+		if (tb.is_valid()) tb.release_read(data);
+		obj->lease_state_.fetch_sub(1, std::memory_order_release);
+	}
+
+	/** @brief It acquires a write lease on the raw memory of an object.
+
+		For a triple buffered image it returns the back buffer, which is 
+		never read, so read leases do not block it (unless they pin all the
+		other frames). A single writer holds the lease.
+		@param[out] bytes Size of the memory.
+		@return The memory to fill, or nullptr if the object is leased.
+	*/
+	void* object_acquire_write(size_t id_obj, size_t &bytes) {
+		bytes = 0;
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (obj == nullptr) return nullptr;
+		if (!is_triple_buffer(id_obj)) {
+			uint32_t expected = 0;
+			if (!obj->lease_state_.compare_exchange_strong(expected,
+				kSharedLeaseWriter, std::memory_order_acquire)) {
+				return nullptr;
+			}
+			return smm_.object_get_ptr(id_obj, bytes);
+		}
+		// the readers of a triple buffer are not excluded
+		uint32_t state = obj->lease_state_.load(std::memory_order_relaxed);
+		do {
+			if (state & (kSharedLeaseWriter | kSharedLeaseResize)) {
+				return nullptr;
+			}
+		} while (!obj->lease_state_.compare_exchange_weak(state,
+			state | kSharedLeaseWriter, std::memory_order_acquire,
+			std::memory_order_relaxed));
+		SharedTripleBuffer tb = image_triple_buffer(id_obj);
+		void *ptr = tb.begin_write();
+		if (ptr == nullptr) {
+			obj->lease_state_.fetch_and(~kSharedLeaseWriter,
+				std::memory_order_release);
+			return nullptr;
+		}
+		bytes = tb.buffer_bytes();
+		return ptr;
+	}
+
+	/** @brief It releases a write lease.
+
+		@param[in] do_publish If true the written memory is published (triple
+		           buffer) and the object is notified.
+	*/
+	void object_release_write(size_t id_obj, bool do_publish) {
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (obj == nullptr) return;
+		SharedTripleBuffer tb = image_triple_buffer(id_obj);
+		if (do_publish && tb.is_valid()) {
+			obj->publish(tb.buffer_bytes(), [&tb]() { tb.commit_write(); });
+		} else if (do_publish) {
+			obj->publish(obj->ptr_size());
+		}
+		obj->lease_state_.fetch_and(~kSharedLeaseWriter,
+			std::memory_order_release);
+		if (do_publish) notify_object(id_obj);
+	}
+
+	/** @brief It returns the header of the last publication of an object
+	           (sequence, producer time and payload length).
+
+		For a single buffered object the header and the payload are
+		consistent while a read lease is held. For a triple buffer or a ring
+		the header describes the most recent publication, which may be newer
+		than the frame just read if the producer published in the meantime.
+	*/
+	bool object_header(size_t id_obj, SharedObjectHeader &header) {
+		return smm_.object_header(id_obj, header);
+	}
 
 	/** @brief It push a source image in the shared memory
 
@@ -217,6 +603,16 @@ public:
 		return false;
 	}
 
+	/** @brief It copies the double vector of an object
+	*/
+	bool object_get_Vecd(
+		const SharedObjectHandle &handle,
+		std::vector<double> &values) {
+		if (!handle.is_valid()) return false;
+		smm_.object_Vecd_copyTo(handle.id, values);
+		return true;
+	}
+
 	/** @brief It push a source image in the shared memory
 
 		@previous_name get_object_values
@@ -232,6 +628,16 @@ public:
 		return false;
 	}
 
+	/** @brief It copies the int vector of an object
+	*/
+	bool object_get_Veci(
+		const SharedObjectHandle &handle,
+		std::vector<int> &values) {
+		if (!handle.is_valid()) return false;
+		smm_.object_Veci_copyTo(handle.id, values);
+		return true;
+	}
+
 	//bool object_Veci_modify(
 	//	size_t key_id, size_t elem_id, int value) {
 	//	smm_.object_Veci_modify(key_id, elem_id, value);
@@ -245,12 +651,149 @@ public:
 		return smm_;
 	}
 
+	/** @brief It sets how parse and detect map the shared memory
+	           (huge pages, prefault, lock, file, persistent)
+	*/
+	void set_memory_options(const SharedMemoryOptions &options) {
+		memory_options_ = options;
+	}
+
+	/** @brief It writes the memory to disk (see
+	           SharedMemoryManager::checkpoint)
+	*/
+	bool checkpoint(const std::string &filename = std::string()) {
+		return smm_.checkpoint(filename);
+	}
+
+	/** @brief It sets the CPUs of the threads started by start() and
+	           start_event_loop() (empty: no affinity).
+	*/
+	void set_thread_affinity(const std::vector<int> &cpus) {
+		thread_cpus_ = cpus;
+	}
+
+	/** @brief It sets the CPUs of the thread that listens for an object.
+	*/
+	void set_thread_affinity(size_t object_id, const std::vector<int> &cpus) {
+		object_thread_cpus_[object_id] = cpus;
+	}
+
+	/** @brief It runs the thread that listens for an object on the CPUs of
+	           the NUMA node of its memory.
+	*/
+	bool set_thread_affinity_node(size_t object_id) {
+		SharedObject *obj = smm_.shared_object(object_id);
+		std::vector<int> cpus;
+		if (obj == nullptr ||
+			!SharedNuma::node_cpus(obj->numa_node_, cpus)) {
+			return false;
+		}
+		object_thread_cpus_[object_id] = cpus;
+		return true;
+	}
+
+	/** @brief It sets the scheduling policy of the threads started by
+	           start() and start_event_loop(). It replaces the thread_priority
+	           passed to them.
+	*/
+	void set_thread_policy(const SharedThreadPolicy &policy) {
+		thread_policy_ = policy;
+	}
+
+	/** @brief It sets the scheduling policy of the thread that listens for
+	           an object.
+	*/
+	void set_thread_policy(size_t object_id,
+		const SharedThreadPolicy &policy) {
+		object_thread_policy_[object_id] = policy;
+	}
+
+	/** @brief It places the raw memory of an object on a NUMA node
+	*/
+	bool object_bind_node(size_t object_id, int node) {
+		return smm_.object_bind_node(object_id, node);
+	}
+
 protected:
 
+	/** @brief It returns true if the object is a triple buffered image.
+
+		The raw memory is not read, so the check is valid without a lease.
+	*/
+	bool is_triple_buffer(size_t id_obj) {
+		bool err = false;
+		return smm_.object_Veci(id_obj, 1, err) == kImageBufferTriple && !err &&
+			smm_.shared_object(id_obj)->object_type_ == "image";
+	}
+
+	/** @brief It returns the triple buffer of an image object.
+
+		The view is not valid if the object is not a triple buffered image.
+	*/
+	SharedTripleBuffer image_triple_buffer(size_t id_obj) {
+		if (is_triple_buffer(id_obj)) return object_get_triple_buffer(id_obj);
+		return SharedTripleBuffer();
+	}
+
+	/** @brief It applies the scheduling policy and the affinity of an
+	           object (or the default ones) to the calling thread.
+
+		The policy set with set_thread_policy has precedence over
+		thread_priority.
+	*/
+	void apply_thread_policy(size_t object_id, int thread_priority) {
+		SharedThreadPolicy policy = thread_priority_policy(thread_priority);
+		auto it_policy = object_thread_policy_.find(object_id);
+		if (it_policy != object_thread_policy_.end()) {
+			policy = it_policy->second;
+		} else if (!thread_policy_.is_default()) {
+			policy = thread_policy_;
+		}
+		auto it = object_thread_cpus_.find(object_id);
+		if (it != object_thread_cpus_.end()) {
+			policy.cpus = it->second;
+		} else if (!thread_cpus_.empty()) {
+			policy.cpus = thread_cpus_;
+		}
+		// one isolated CPU for each thread
+		std::vector<int> isolated;
+		if (policy.isolated && policy.cpus.empty() &&
+			SharedThreadPolicy::isolated_cpus(isolated)) {
+			size_t n = next_isolated_cpu_.fetch_add(1);
+			policy.cpus.push_back(isolated[n % isolated.size()]);
+		}
+		if (!policy.is_default() && !policy.apply()) {
+			std::cout << "Unable to apply the policy of the thread: " <<
+				object_id << std::endl;
+		}
+	}
+
+	/** @brief It returns the policy of a kThreadPriority* value.
+
+		As in the previous versions only kThreadPriorityBackgroundBegin
+		changes the thread, and only on Windows (background mode). The
+		other schedulers (i.e. real time kSharedSchedFifo) are chosen with
+		set_thread_policy.
+	*/
+	static SharedThreadPolicy thread_priority_policy(int thread_priority) {
+		SharedThreadPolicy policy;
+#if defined(_WIN32)
+		if (thread_priority == kThreadPriorityBackgroundBegin) {
+			policy.scheduler = kSharedSchedBatch;
+		}
+#else
+		(void)thread_priority;
+#endif
+		return policy;
+	}
+
 	/** @brief Shared memory
 	*/
 	SharedMemoryManager smm_;
 	std::string name_shm_;
+	/** @brief How to map the shared memory
+	*/
+	SharedMemoryOptions memory_options_;
 
 	/** @brief container with the bytes to instantiate for each object
 	*/
@@ -270,12 +813,34 @@ protected:
 	/** @brief Thread of the process
 	*/
 	std::vector<std::thread> container_t_process_;
+	/** @brief CPUs of the threads (empty: no affinity)
+	*/
+	std::vector<int> thread_cpus_;
+	/** @brief CPUs of the thread of an object
+	*/
+	std::map<size_t, std::vector<int> > object_thread_cpus_;
+	/** @brief Scheduling policy of the threads
+	*/
+	SharedThreadPolicy thread_policy_;
+	/** @brief Scheduling policy of the thread of an object
+	*/
+	std::map<size_t, SharedThreadPolicy> object_thread_policy_;
+	/** @brief Next isolated CPU to assign to a thread
+	*/
+	std::atomic<size_t> next_isolated_cpu_;
 
 
 	/** @brief Container with the callback functions
 	*/
 	registration_callback_function_shared f_callback_;
 
+	/** @brief How this process waits for the objects (kNotification*)
+	*/
+	int notification_mode_;
+	/** @brief Time of busy polling before blocking (ns)
+	*/
+	int64_t wait_spin_ns_;
+
 	///** @brief It guarantee that the passed data is valid
 	//*/
 	//std::mutex c_mutex_;
@@ -299,6 +864,11 @@ protected:
 	*/
 	std::vector<boost::interprocess::interprocess_mutex*> v_obj_mtx_;
 	std::vector<boost::interprocess::interprocess_condition*> v_obj_cnd_;
+
+	/** @brief Counter incremented at each notification of any object. It is
+	           the readiness word of the event loops.
+	*/
+	std::atomic<uint32_t>* global_seq_;
 };
 
 } // namespace shm
@@ -25,9 +25,10 @@
 #ifndef COMMONOBJECTS_SHMCOMMON_SHAREDDATADERIVEDSAMPLE_HPP__
 #define COMMONOBJECTS_SHMCOMMON_SHAREDDATADERIVEDSAMPLE_HPP__
 
-#include "SharedDataBase.hpp"
+#include <algorithm>
 
-#include <windows.h>
+#include "SharedDataBase.hpp"
+#include "SharedTap.hpp"
 
 namespace co
 {
@@ -38,6 +39,10 @@ namespace shm
 */
 const int kSharedDataProcessTimeout = 1000;
 
+/** @brief Memory reserved for the bookkeeping of each object (bytes)
+*/
+const size_t kSharedObjectBookkeepingBytes = 1024;
+
 // Size of each point in bytes
 typedef int SizeOfEachPointBytes;
 // Total number of points for an object
@@ -56,6 +61,26 @@ struct ObservedObject
 	int num_points;
 };
 
+/** @brief Frame of an object of a group (see group_publish and group_read)
+*/
+struct SharedGroupFrame
+{
+	SharedGroupFrame() : id(0), data(nullptr), bytes(0) {}
+	SharedGroupFrame(size_t id, void *data, size_t bytes) :
+		id(id), data(data), bytes(bytes) {}
+
+	/** @brief Object id
+	*/
+	size_t id;
+	/** @brief Frame to publish, or memory where to copy the frame read
+	*/
+	void *data;
+	/** @brief Size of the frame (publish), or size of data in input and
+	           size of the frame read in output (read)
+	*/
+	size_t bytes;
+};
+
 /** @brief Class to manage a shared data
 
 The shared objects contains the information of 3D cloud points
@@ -75,6 +100,10 @@ public:
 
 	~SharedDataDerivedSample() {
 		stop();
+		// release the cursors of the broadcast rings
+		for (auto &it : broadcast_readers_) {
+			object_get_broadcast(it.first).detach(it.second);
+		}
 	}
 
 	/** expected
@@ -86,6 +115,11 @@ public:
 		parameter (use default true).
 		The function estimates the memory to allocate, and a recoursive
 		call set the values.
+		An image (image,name,width,height,channels) followed by "triple" is
+		triple buffered: one producer and any number of consumers. Each
+		read lease pins the latest frame, and the producer fails to write
+		(image_copyFrom returns false) while the leases pin the two other
+		frames.
 	*/
 	int parse(
 		const std::string &name_shm,
@@ -110,6 +144,10 @@ public:
 
 		// parse the request
 		std::vector<std::string> words = co::text::StringOp::split(msg, '|');
+		// bookkeeping of each object (named mutex, condition, allocator) and
+		// padding to align the raw memory
+		memory_buffer += words.size() * (kSharedObjectBookkeepingBytes +
+			2 * memory_options_.alignment);
 		for (auto &it : words) {
 			std::vector<std::string> words2 = co::text::StringOp::split(it, ',');
 			if (words2.size() >= 2) {
@@ -135,12 +173,7 @@ public:
 					if (!do_allocate) {
 						// Set the key id
 						key_id.insert(std::make_pair(type, object_id));
-						// set the maximum number of points and other information
-						smm_.object_Veci_copyFrom(object_id, std::vector<int>({ num_points, 0 }));
-						// set object type
-						smm_.set_object_type(object_id, type);
-						// set object name
-						smm_.set_object_name(object_id, name);
+						setup_pcl(object_id, name, num_points);
 						++object_id;
 					}
 				} else if (type == "pose_kSize") {
@@ -156,44 +189,31 @@ public:
 					if (!do_allocate) {
 						// Set the key id
 						key_id.insert(std::make_pair(type, object_id));
-						// set the maximum number of points and other information
-						smm_.object_Veci_copyFrom(object_id, std::vector<int>({
-							num_skeletons * num_points_skeleton, 0,
-							num_points_skeleton }));
-						// set object type
-						smm_.set_object_type(object_id, type);
-						// set object name
-						smm_.set_object_name(object_id, name);
+						setup_pose(object_id, name, num_skeletons,
+							num_points_skeleton);
 						++object_id;
 					}
 				} else if (type == "image") {
-					// i.e. image,640,480,3
+					// i.e. image,640,480,3 or image,640,480,3,triple
 					int width = std::stoi(words2[2]);
 					int height = std::stoi(words2[3]);
 					int channels = std::stoi(words2[4]);
+					int buffer_mode = kImageBufferSingle;
+					if (words2.size() >= 6 && words2[5] == "triple") {
+						buffer_mode = kImageBufferTriple;
+					}
+					size_t size_byte = width * height * channels;
+					if (buffer_mode == kImageBufferTriple) {
+						size_byte = SharedTripleBuffer::memory_size(size_byte);
+					}
 					// Set the camera image
-					v_.push_back(width * height * channels); // set the image size
-					memory_to_allocate_bytes_ += width * height * channels;
+					v_.push_back(size_byte); // set the image size
+					memory_to_allocate_bytes_ += size_byte;
 					if (!do_allocate) {
 						// Set the key id
 						key_id.insert(std::make_pair(type, object_id));
-						// Set the information to share with another process
-						std::vector<int> ready_status;
-						std::vector<double> value;
-						value.clear();
-						value.push_back(width);
-						value.push_back(height);
-						value.push_back(channels);
-						value.push_back(0); // timestamp
-						value.push_back(0); // frame_id
-						ready_status.clear();
-						ready_status.push_back(1);
-						smm_.object_copyFrom(object_id, "image_info", value);
-						smm_.object_copyFrom(object_id, "ready_status", ready_status);
-						// set object type
-						smm_.set_object_type(object_id, type);
-						// set object name
-						smm_.set_object_name(object_id, name);
+						setup_image(object_id, name, width, height, channels,
+							buffer_mode);
 						++object_id;
 					}
 				} else if (type == "yolo") {
@@ -207,10 +227,7 @@ public:
 					if (!do_allocate) {
 						// Set the key id
 						key_id.insert(std::make_pair(type, object_id));
-						// set object type
-						smm_.set_object_type(object_id, type);
-						// set object name
-						smm_.set_object_name(object_id, name);
+						setup_object(object_id, type, name);
 						++object_id;
 					}
 				}
@@ -223,10 +240,63 @@ public:
 					if (!do_allocate) {
 						// Set the key id
 						key_id.insert(std::make_pair(type, object_id));
-						// set object type
-						smm_.set_object_type(object_id, type);
-						// set object name
-						smm_.set_object_name(object_id, name);
+						setup_object(object_id, type, name);
+						++object_id;
+					}
+				}
+				else if (type == "ring") {
+					// i.e. ring,name,921600,4
+					// single producer/single consumer ring of frames
+					int slot_bytes = std::stoi(words2[2]);
+					int num_slots = std::stoi(words2[3]);
+					size_t size_byte = SharedFrameRing::memory_size(
+						slot_bytes, num_slots);
+					v_.push_back(size_byte);
+					memory_to_allocate_bytes_ += size_byte;
+					if (!do_allocate) {
+						// Set the key id
+						key_id.insert(std::make_pair(type, object_id));
+						setup_ring(object_id, name, slot_bytes, num_slots);
+						++object_id;
+					}
+				}
+				else if (type == "broadcast") {
+					// i.e. broadcast,name,921600,8,4 or broadcast,name,921600,8,4,block
+					// single producer/multiple consumers ring of frames
+					int slot_bytes = std::stoi(words2[2]);
+					int num_slots = std::stoi(words2[3]);
+					int max_readers = std::stoi(words2[4]);
+					int mode = kBroadcastOverwrite;
+					if (words2.size() >= 6 && words2[5] == "block") {
+						mode = kBroadcastBlock;
+					}
+					size_t size_byte = SharedBroadcastRing::memory_size(
+						slot_bytes, num_slots, max_readers);
+					v_.push_back(size_byte);
+					memory_to_allocate_bytes_ += size_byte;
+					if (!do_allocate) {
+						// Set the key id
+						key_id.insert(std::make_pair(type, object_id));
+						setup_broadcast(object_id, name, slot_bytes, num_slots,
+							max_readers, mode);
+						++object_id;
+					}
+				}
+				else if (type == "pool") {
+					// i.e. pool,name,921600,8,4
+					// reference counted frames (slot size, slots, queue size)
+					int slot_bytes = std::stoi(words2[2]);
+					int num_slots = std::stoi(words2[3]);
+					int queue_size = std::stoi(words2[4]);
+					size_t size_byte = SharedFramePool::memory_size(
+						slot_bytes, num_slots, queue_size);
+					v_.push_back(size_byte);
+					memory_to_allocate_bytes_ += size_byte;
+					if (!do_allocate) {
+						// Set the key id
+						key_id.insert(std::make_pair(type, object_id));
+						setup_pool(object_id, name, slot_bytes, num_slots,
+							queue_size);
 						++object_id;
 					}
 				}
@@ -235,9 +305,21 @@ public:
 
 		// Create the memory space
 		if (do_allocate) {
+			// a persistent segment with the same layout keeps its content
+			// (warm restart)
+			if (memory_options_.persistent && detect(name_shm, name_object_shm)) {
+				if (*smm_.find_or_create_value64("layout_hash") ==
+					SharedMemoryManager::hash_name(msg.data(), msg.size())) {
+					std::cout << "Warm restart: " << name_shm << std::endl;
+					smm_.recover();
+					return err;
+				}
+				v_obj_mtx_.clear();
+				v_obj_cnd_.clear();
+			}
 			// create the memory (allocate the necessary space)
 			if (!smm_.create(name_shm_, memory_to_allocate_bytes_ +
-				memory_buffer)) {
+				memory_buffer, memory_options_)) {
 				std::cout << "Unable to create: " << name_shm_ << std::endl;
 				// error
 				return kSharedUnableToCreateSharedMemory;
@@ -247,29 +329,103 @@ public:
 			// parse the string again to instantiate the parameters
 			parse(name_shm, name_object_shm, msg, false);
 		} else {
-			// It creates the mutex and condition variable for whole process
-			global_mtx_ =
-				smm_.find_or_create_mutex("global_mtx");
-			global_cnd_ =
-				smm_.find_or_create_condition("global_cnd");
-
-			// it creates the mutex and condition variable
-			for (size_t i = 0; i < smm_.num_items(); ++i) {
-				std::string name = "obj_mtx" + std::to_string(i);
-				v_obj_mtx_.push_back(
-					smm_.find_or_create_mutex(name.c_str())
-				);
-			}
-			for (size_t i = 0; i < smm_.num_items(); ++i) {
-				std::string name = "obj_cnd" + std::to_string(i);
-				v_obj_cnd_.push_back(
-					smm_.find_or_create_condition(name.c_str())
-				);
-			}
+			publish_layout(msg);
 		}
 		return err;
 	}
 
+	/** @brief It sets the type and the name of an object.
+	*/
+	void setup_object(size_t id_obj, const std::string &type,
+		const std::string &name) {
+		smm_.set_object_type(id_obj, type);
+		smm_.set_object_name(id_obj, name);
+	}
+
+	/** @brief It sets the information of a point cloud (parse, pcl).
+	*/
+	void setup_pcl(size_t id_obj, const std::string &name, int num_points) {
+		// set the maximum number of points and other information
+		smm_.object_Veci_copyFrom(id_obj, std::vector<int>({ num_points, 0 }));
+		setup_object(id_obj, "pcl", name);
+	}
+
+	/** @brief It sets the information of the skeletons (parse, pose_kSize).
+	*/
+	void setup_pose(size_t id_obj, const std::string &name,
+		int num_skeletons, int num_points_skeleton) {
+		// set the maximum number of points and other information
+		smm_.object_Veci_copyFrom(id_obj, std::vector<int>({
+			num_skeletons * num_points_skeleton, 0, num_points_skeleton }));
+		setup_object(id_obj, "pose_kSize", name);
+	}
+
+	/** @brief It sets the information of an image (parse, image), and
+	           initializes its triple buffer.
+	*/
+	void setup_image(size_t id_obj, const std::string &name, int width,
+		int height, int channels, int buffer_mode) {
+		// Set the information to share with another process
+		std::vector<double> value({ static_cast<double>(width),
+			static_cast<double>(height), static_cast<double>(channels),
+			0,    // timestamp
+			0 }); // frame_id
+		std::vector<int> ready_status({ 1, buffer_mode });
+		smm_.object_copyFrom(id_obj, "image_info", value);
+		smm_.object_copyFrom(id_obj, "ready_status", ready_status);
+		if (buffer_mode == kImageBufferTriple) {
+			size_t size = 0;
+			SharedTripleBuffer(smm_.object_get_ptr(id_obj, size)).
+				initialize(width * height * channels);
+		}
+		setup_object(id_obj, "image", name);
+	}
+
+	/** @brief It sets the information of a ring and initializes it
+	           (parse, ring).
+	*/
+	void setup_ring(size_t id_obj, const std::string &name, int slot_bytes,
+		int num_slots) {
+		// set the slot size and the number of slots
+		smm_.object_Veci_copyFrom(id_obj, std::vector<int>({
+			slot_bytes, num_slots }));
+		// initialize the ring in the raw memory
+		size_t size = 0;
+		SharedFrameRing(smm_.object_get_ptr(id_obj, size)).
+			initialize(slot_bytes, num_slots);
+		setup_object(id_obj, "ring", name);
+	}
+
+	/** @brief It sets the information of a broadcast ring and initializes
+	           it (parse, broadcast).
+	*/
+	void setup_broadcast(size_t id_obj, const std::string &name,
+		int slot_bytes, int num_slots, int max_readers, int mode) {
+		// set the slot size, number of slots and readers
+		smm_.object_Veci_copyFrom(id_obj, std::vector<int>({
+			slot_bytes, num_slots, max_readers, mode }));
+		// initialize the ring in the raw memory
+		size_t size = 0;
+		SharedBroadcastRing(smm_.object_get_ptr(id_obj, size)).
+			initialize(slot_bytes, num_slots, max_readers, mode);
+		setup_object(id_obj, "broadcast", name);
+	}
+
+	/** @brief It sets the information of a pool and initializes it
+	           (parse, pool).
+	*/
+	void setup_pool(size_t id_obj, const std::string &name, int slot_bytes,
+		int num_slots, int queue_size) {
+		// set the slot size, number of slots and queue size
+		smm_.object_Veci_copyFrom(id_obj, std::vector<int>({
+			slot_bytes, num_slots, queue_size }));
+		// initialize the pool in the raw memory
+		size_t size = 0;
+		SharedFramePool(smm_.object_get_ptr(id_obj, size)).
+			initialize(slot_bytes, num_slots, queue_size);
+		setup_object(id_obj, "pool", name);
+	}
+
 
 	/** @brief It detects the memory which will contain the structured data.
 
@@ -284,7 +440,7 @@ public:
 		// copy the name of the shared memory
 		name_shm_ = name_shm;
 
-		if (!smm_.detect(name_shm_, name_object_shm)) {
+		if (!smm_.detect(name_shm_, name_object_shm, memory_options_)) {
 			std::cout << "Unable to detect: " << name_shm << std::endl;
 			return false;
 		}
@@ -294,6 +450,8 @@ public:
 			smm_.find_or_create_mutex("global_mtx");
 		global_cnd_ =
 			smm_.find_or_create_condition("global_cnd");
+		global_seq_ =
+			smm_.find_or_create_counter("global_seq");
 
 		// It creates the mutex and condition variable for the existing
 		// objects
@@ -314,26 +472,90 @@ public:
 	}
 
 
+	/** @brief It allocates the objects described by a schema (see
+	           SharedSchema).
+
+		The sizes of the raw memory are computed at compile time and each
+		descriptor sets the information of its object: no message is
+		parsed. The hash of the schema is saved in the shared memory before
+		the index of the objects and the global mutex are created, so a
+		consumer that detects the memory always compares it.
+	*/
+	template<typename Schema>
+	int parse_schema(
+		const std::string &name_shm,
+		const std::string &name_object_shm) {
+
+		name_shm_ = name_shm;
+		v_ = Schema::raw_sizes();
+		memory_to_allocate_bytes_ = Schema::raw_bytes();
+		size_t memory_buffer = 4096 + Schema::size() *
+			(kSharedObjectBookkeepingBytes + 2 * memory_options_.alignment);
+		if (!smm_.create(name_shm_, memory_to_allocate_bytes_ + memory_buffer,
+			memory_options_)) {
+			std::cout << "Unable to create: " << name_shm_ << std::endl;
+			return kSharedUnableToCreateSharedMemory;
+		}
+		*smm_.find_or_create_value64("schema_hash") = Schema::hash();
+		smm_.instantiate(name_object_shm, v_);
+		Schema::setup(*this);
+		publish_layout(Schema::message());
+		return kSharedNoError;
+	}
+
+	/** @brief It detects a memory created with the same schema.
+
+		It fails if the hash of the schema saved by the producer is 
+		different, or if the objects (type, name, raw memory) do not match.
+		A memory created by parse has no hash, only the objects are checked.
+	*/
+	template<typename Schema>
+	bool detect_schema(
+		const std::string &name_shm,
+		const std::string &name_object_shm) {
+
+		if (!detect(name_shm, name_object_shm)) return false;
+		uint64_t *hash = smm_.find_value64("schema_hash");
+		if (hash != nullptr && *hash != 0 && *hash != Schema::hash()) {
+			std::cout << "Schema mismatch: " << name_shm << std::endl;
+			return false;
+		}
+		std::vector<size_t> sizes = Schema::raw_sizes();
+		std::vector<std::string> names = Schema::names();
+		std::vector<std::string> types = Schema::types();
+		if (smm_.num_items() != sizes.size()) {
+			std::cout << "Schema mismatch: " << smm_.num_items() <<
+				" objects, expected " << sizes.size() << std::endl;
+			return false;
+		}
+		for (size_t i = 0; i < sizes.size(); ++i) {
+			SharedObject *obj = smm_.shared_object(i);
+			size_t size = 0;
+			smm_.object_get_ptr(i, size);
+			if (std::string(obj->object_type_.c_str()) != types[i] ||
+				std::string(obj->object_name_.c_str()) != names[i] ||
+				size != sizes[i]) {
+				std::cout << "Schema mismatch: object " << i << " " <<
+					obj->object_name_ << " (" << obj->object_type_ << ", " <<
+					size << " bytes), expected " << names[i] << " (" <<
+					types[i] << ", " << sizes[i] << " bytes)" << std::endl;
+				return false;
+			}
+		}
+		return true;
+	}
+
+
 	/** @brief If started from the function "start()" it will run in a
 			   separated thread.
 	*/
-	void process(int thread_priority) {
+	void process(int /*thread_priority*/) {
 		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock{ *global_mtx_ };
 		bool noTimeout = true;
 
 		//Print messages until the other process marks the end
 		size_t num_sources = smm_.num_items();
 
-		switch (thread_priority) {
-		case kThreadPriorityNone:
-			break;
-		case kThreadPriorityBackgroundBegin:
-			// Increase the thread priority
-			SetThreadPriority(GetCurrentThread(),
-				THREAD_MODE_BACKGROUND_BEGIN);
-			break;
-		}
-
 		// image used to close the program
 		bool valid_data = false;
 		do_continue_ = true;
@@ -395,33 +617,40 @@ public:
 	           when event occurrs.
 	*/
 	void process_id(int thread_priority, size_t object_id) {
+		if (notification_mode_ == kNotificationFutex) {
+			process_id_futex(thread_priority, object_id);
+			return;
+		}
 		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock{ *v_obj_mtx_[object_id] };
 		bool noTimeout = true;
 
 		//Print messages until the other process marks the end
 		size_t num_sources = smm_.num_items();
 
-		switch (thread_priority) {
-		case kThreadPriorityNone:
-			break;
-		case kThreadPriorityBackgroundBegin:
-			// Increase the thread priority
-			SetThreadPriority(GetCurrentThread(),
-				THREAD_MODE_BACKGROUND_BEGIN);
-			break;
-		}
-
 		// image used to close the program
 		bool valid_data = false;
+		SharedObject *obj = smm_.shared_object(object_id);
+		uint64_t last_write = obj->stats_.write_count.load(
+			std::memory_order_acquire);
+		uint32_t last = SharedNotifier::load(&obj->notify_seq_);
 		do_continue_ = true;
 		do {
 			//double start = cv::getTickCount();
 			// In normal condition it should be locked
 			v_obj_cnd_[object_id]->notify_all();
 
-			// wait?
-			boost::system_time timeout = boost::get_system_time() + boost::posix_time::milliseconds(kSharedDataProcessTimeout);
-			noTimeout = v_obj_cnd_[object_id]->timed_wait(lock, timeout);
+			// busy polling before the wait (see set_wait_spin)
+			if (SharedNotifier::spin(&obj->notify_seq_, last, wait_spin_ns_)) {
+				noTimeout = true;
+			} else {
+				// wait?
+				boost::system_time timeout = boost::get_system_time() + boost::posix_time::milliseconds(kSharedDataProcessTimeout);
+				noTimeout = v_obj_cnd_[object_id]->timed_wait(lock, timeout);
+				// a notification sent while this thread was not waiting
+				uint32_t current = SharedNotifier::load(&obj->notify_seq_);
+				if (current != last) noTimeout = true;
+				last = current;
+			}
 			// timeout
 			if (!noTimeout)
 			{
@@ -435,8 +664,8 @@ public:
 
 			//std::cout << "<> notify to server" << std::endl;
 			// callback here
-			if (f_callback_ != nullptr && valid_data) {
-				f_callback_(object_id, smm_);
+			if (valid_data) {
+				dispatch_callback(object_id, last_write);
 			}
 			// invalidate the data
 			valid_data = false;
@@ -468,6 +697,37 @@ public:
 	}
 
 
+	/** @brief It process a set of objects in a single thread (event loop)
+	*/
+	void process_events(int thread_priority, std::vector<size_t> which) {
+		SharedDataBase::process_events(thread_priority, which);
+		std::cout << "</SharedDataClient::process_events>" << std::endl;
+	}
+
+
+	/** @brief It process a specific object waiting on the notification
+	           counter of the object (futex backend).
+
+		No mutex is held while waiting or during the callback.
+	*/
+	void process_id_futex(int /*thread_priority*/, size_t object_id) {
+		SharedObject *obj = smm_.shared_object(object_id);
+		if (obj == nullptr) return;
+		uint32_t last = SharedNotifier::load(&obj->notify_seq_);
+		uint64_t last_write = obj->stats_.write_count.load(
+			std::memory_order_acquire);
+
+		do_continue_ = true;
+		do {
+			if (wait_object(object_id, last, kSharedDataProcessTimeout)) {
+				dispatch_callback(object_id, last_write);
+			}
+		} while (do_continue_);
+
+		std::cout << "</SharedDataClient::process>" << std::endl;
+	}
+
+
 	/** @brief It push new data
 
 		It pushes a new data.
@@ -480,8 +740,9 @@ public:
 			id_obj >= 0 && id_obj < smm_.num_items()) {
 			// update
 			smm_.object_set_string(id_obj, msg);
+			smm_.shared_object(id_obj)->publish(msg.size());
 			// notify
-			v_obj_cnd_[id_obj]->notify_all();
+			notify_object(id_obj);
 			//std::unique_lock<std::mutex> lk(c_mutex_);
 			//smm_.set(id_obj, msg);
 			//c_is_ready_ = true;
@@ -496,8 +757,9 @@ public:
 		if (id_obj >= 0 && id_obj < smm_.num_items()) {
 			// update
 			smm_.object_set_string(id_obj, msg);
+			smm_.shared_object(id_obj)->publish(msg.size());
 			// notify
-			v_obj_cnd_[id_obj]->notify_all();
+			notify_object(id_obj);
 			//std::unique_lock<std::mutex> lk(c_mutex_);
 			//smm_.set(id_obj, msg);
 			//c_is_ready_ = true;
@@ -528,7 +790,11 @@ public:
 				auto obj = smm_.shared_object(id_obj);
 				//std::cout << "obj: " << obj << std::endl;
 				if (obj != nullptr) {
-					obj->int_vector_[1] = it.second.num_points;
+					{
+						SharedSeqlockWriteGuard guard(obj->meta_lock_);
+						obj->int_vector_[1] = it.second.num_points;
+					}
+					obj->publish(sizeof(float) * it.second.points_data.size());
 					// sum points
 					//num_points += it.second.num_points;
 					//std::cout << "Obj: " << it.first << " " << id_obj << " " << obj->int_vector_[1] << " " << it.second.num_points << std::endl;
@@ -613,6 +879,614 @@ public:
 	//	}
 	//}
 
+	/** @brief It attaches this process as a new reader of a broadcast
+	           object (usually after detect).
+
+		The reader receives the frames published from now on. The cursor
+		is released by broadcast_detach or by the destructor.
+		@return The reader index or kBroadcastInvalidReader.
+	*/
+	int broadcast_attach(size_t id_obj) {
+		int reader = object_get_broadcast(id_obj).attach();
+		if (reader != kBroadcastInvalidReader) {
+			broadcast_readers_.push_back(std::make_pair(id_obj, reader));
+		}
+		return reader;
+	}
+
+	/** @brief It detaches a reader of a broadcast object
+	*/
+	void broadcast_detach(size_t id_obj, int reader) {
+		object_get_broadcast(id_obj).detach(reader);
+		broadcast_readers_.erase(std::remove(broadcast_readers_.begin(),
+			broadcast_readers_.end(), std::make_pair(id_obj, reader)),
+			broadcast_readers_.end());
+	}
+
+	/** @brief It publishes a new frame to all the readers of a broadcast
+	           object and notifies them.
+
+		@return It returns false if the frame is too large or, with the
+		        block mode, the slowest reader is a full ring behind.
+	*/
+	bool broadcast_publish(size_t id_obj, const void *data, size_t bytes) {
+		SharedBroadcastRing ring = object_get_broadcast(id_obj);
+		if (!ring.publish(data, bytes)) return false;
+		smm_.shared_object(id_obj)->publish(bytes);
+		notify_object(id_obj);
+		return true;
+	}
+
+	/** @brief It copies the next frame of a reader of a broadcast object
+
+		A callback should read until the function returns false. A frame
+		larger than max_bytes is skipped and counted in lost.
+		@param[out] bytes Number of bytes copied in data.
+		@param[out] lost Frames overwritten or skipped before the reader
+		            got them.
+		@return It returns false if there is no new frame.
+	*/
+	bool broadcast_read(size_t id_obj, int reader, void *data,
+		size_t max_bytes, size_t &bytes, uint64_t &lost) {
+		SharedBroadcastRing ring = object_get_broadcast(id_obj);
+		return ring.read(reader, data, max_bytes, bytes, lost);
+	}
+
+	/** @brief It takes a free frame of a pool object to fill
+
+		@param[out] data Memory of the frame.
+		@return The handle or kSharedFrameInvalidHandle if all the frames
+		        are in use.
+	*/
+	SharedFrameHandle pool_allocate(size_t id_obj, void* &data) {
+		SharedFramePool pool = object_get_pool(id_obj);
+		SharedFrameHandle handle = pool.allocate();
+		data = pool.data(handle);
+		return handle;
+	}
+
+	/** @brief It publishes a frame of a pool object and notifies the
+	           consumers. The frame is handed off to the pool: the caller
+	           must not release it.
+	*/
+	bool pool_publish(size_t id_obj, SharedFrameHandle handle, size_t bytes) {
+		SharedFramePool pool = object_get_pool(id_obj);
+		pool.set_bytes(handle, bytes);
+		if (!pool.publish(handle)) return false;
+		smm_.shared_object(id_obj)->publish(bytes);
+		notify_object(id_obj);
+		return true;
+	}
+
+	/** @brief It takes a reference to the next frame published in a pool
+	           object. The frame is not copied and is not modified until
+	           pool_release is called.
+
+		@param[in,out] cursor Sequence of the next frame (kept by the
+		               consumer).
+		@param[out] data Memory of the frame.
+		@param[out] bytes Size of the frame.
+	*/
+	SharedFrameHandle pool_acquire_next(size_t id_obj, uint64_t &cursor,
+		const void* &data, size_t &bytes) {
+		SharedFramePool pool = object_get_pool(id_obj);
+		SharedFrameHandle handle = pool.acquire_next(cursor);
+		data = pool.data(handle);
+		bytes = pool.bytes(handle);
+		return handle;
+	}
+
+	/** @brief It releases a frame taken from a pool object
+	*/
+	void pool_release(size_t id_obj, SharedFrameHandle handle) {
+		object_get_pool(id_obj).release(handle);
+	}
+
+	/** @brief It push a new frame in a ring object
+
+		The frame is copied in the next free slot without locking any mutex
+		and the consumer is notified.
+		@return It returns false if the ring is full (the consumer is behind)
+		        or the frame is too large. The frame is dropped.
+	*/
+	bool ring_push(size_t id_obj, const void *data, size_t bytes) {
+		SharedFrameRing ring = object_get_ring(id_obj);
+		if (!ring.push(data, bytes)) return false;
+		smm_.shared_object(id_obj)->publish(bytes);
+		notify_object(id_obj);
+		return true;
+	}
+
+	/** @brief It pops the oldest frame from a ring object
+
+		A callback should pop until the function returns false, since a
+		single notification may cover more than one frame.
+		@param[out] bytes Number of bytes copied in data.
+		@return It returns false if the ring is empty.
+	*/
+	bool ring_pop(size_t id_obj, void *data, size_t max_bytes, size_t &bytes) {
+		SharedFrameRing ring = object_get_ring(id_obj);
+		return ring.pop(data, max_bytes, bytes);
+	}
+
+	/** @brief It returns the memory where to write the next image, under
+	           a write lease (see object_acquire_write).
+
+		For a triple buffered image it is the free back buffer, otherwise it
+		is the raw memory of the object. image_write_commit publishes it and
+		releases the lease.
+		@param[out] bytes Size of the image (bytes).
+		@return The memory or nullptr if the image is leased.
+	*/
+	void* image_write_begin(size_t id_obj, size_t &bytes) {
+		return object_acquire_write(id_obj, bytes);
+	}
+
+	/** @brief It publishes the image written in image_write_begin and
+	           notifies the consumers.
+	*/
+	void image_write_commit(size_t id_obj) {
+		object_release_write(id_obj, true);
+	}
+
+	/** @brief It copies an image in the shared memory and notifies it.
+
+		The image is not written (the function returns false) while a read
+		lease pins a single buffered image.
+	*/
+	bool image_copyFrom(size_t id_obj, const void *data, size_t bytes) {
+		size_t max_bytes = 0;
+		void *ptr = object_acquire_write(id_obj, max_bytes);
+		if (ptr == nullptr) return false;
+		if (bytes > max_bytes) {
+			object_release_write(id_obj, false);
+			return false;
+		}
+		memcpy(ptr, data, bytes);
+		object_release_write(id_obj, true);
+		return true;
+	}
+
+	/** @brief It copies the most recent complete image (under a read lease).
+
+		It returns false while a writer holds a single buffered image.
+	*/
+	bool image_copyTo(size_t id_obj, void *data, size_t bytes) {
+		size_t max_bytes = 0;
+		const void *ptr = object_acquire_read(id_obj, max_bytes);
+		if (ptr == nullptr) return false;
+		if (bytes > max_bytes) {
+			object_release_read(id_obj, ptr);
+			return false;
+		}
+		memcpy(data, ptr, bytes);
+		object_release_read(id_obj, ptr);
+		return true;
+	}
+
+	/** @brief It copies in the shared memory only the tiles of an image
+	           that changed since the previous frame, and notifies it.
+
+		The dirty bitmap is saved in the int vector of the object (see
+		kImageDirtyBitmap). If no tile changed the image is not published and
+		the consumers are not notified. The other writes of the image
+		(image_copyFrom, image_write_commit) do not update the bitmap.
+		@param[out] num_dirty Number of tiles that changed.
+		@return It returns false if the image is not written (wrong size or
+		        a read lease pins a single buffered image).
+	*/
+	bool image_copyFrom_dirty(size_t id_obj, const void *data, size_t bytes,
+		size_t &num_dirty, int tile_size = kSharedDirtyTileSize) {
+		num_dirty = 0;
+		std::vector<int> int_values;
+		std::vector<double> double_values;
+		if (tile_size <= 0 ||
+			!smm_.read_consistent(id_obj, int_values, double_values) ||
+			int_values.size() < 2 || double_values.size() < 3) {
+			return false;
+		}
+		int width = static_cast<int>(double_values[0]);
+		int height = static_cast<int>(double_values[1]);
+		int channels = static_cast<int>(double_values[2]);
+		if (bytes != static_cast<size_t>(width) * height * channels) {
+			return false;
+		}
+		size_t max_bytes = 0;
+		uint8_t *ptr = static_cast<uint8_t*>(
+			object_acquire_write(id_obj, max_bytes));
+		if (ptr == nullptr) return false;
+		if (bytes > max_bytes) {
+			object_release_write(id_obj, false);
+			return false;
+		}
+		// compare with the last published frame
+		SharedTripleBuffer tb = image_triple_buffer(id_obj);
+		const uint8_t *reference = tb.is_valid() ?
+			static_cast<const uint8_t*>(tb.latest_written()) : ptr;
+		std::vector<int> bitmap;
+		size_t bytes_copied = 0;
+		num_dirty = SharedDirtyTiles::copy(ptr, reference,
+			static_cast<const uint8_t*>(data), width, height, channels,
+			tile_size, bitmap, bytes_copied);
+		if (num_dirty == 0) {
+			object_release_write(id_obj, false);
+			return true;
+		}
+		// dirty tiles metadata, visible before the notification
+		int_values.resize(kImageDirtyBitmap);
+		int_values[kImageDirtyTileSize] = tile_size;
+		int_values[kImageDirtyNumTiles] = static_cast<int>(num_dirty);
+		int_values.insert(int_values.end(), bitmap.begin(), bitmap.end());
+		smm_.object_Veci_copyFrom(id_obj, int_values.data(), int_values.size());
+		if (tb.is_valid()) {
+			smm_.shared_object(id_obj)->publish(bytes_copied,
+				[&tb]() { tb.commit_write(); });
+		} else {
+			smm_.shared_object(id_obj)->publish(bytes_copied);
+		}
+		smm_.shared_object(id_obj)->lease_state_.fetch_and(
+			~kSharedLeaseWriter, std::memory_order_release);
+		notify_object(id_obj);
+		return true;
+	}
+
+	/** @brief It returns the tiles of an image that changed in the last
+	           publication of image_copyFrom_dirty.
+
+		@param[in,out] last_write Number of writes of the object seen by the
+		               previous call. If some publications have been missed
+		               all the tiles are set as dirty.
+		@param[out] bitmap Dirty bitmap (see SharedDirtyTiles::is_dirty).
+		@param[out] tile_size Side of the tiles (pixels).
+		@return It returns false if the image has no dirty tiles metadata.
+	*/
+	bool image_dirty_tiles(size_t id_obj, uint64_t &last_write,
+		std::vector<int> &bitmap, int &tile_size) {
+		SharedObject *obj = smm_.shared_object(id_obj);
+		std::vector<int> int_values;
+		std::vector<double> double_values;
+		if (obj == nullptr ||
+			!smm_.read_consistent(id_obj, int_values, double_values) ||
+			int_values.size() <= kImageDirtyBitmap ||
+			double_values.size() < 3) {
+			return false;
+		}
+		tile_size = int_values[kImageDirtyTileSize];
+		bitmap.assign(int_values.begin() + kImageDirtyBitmap,
+			int_values.end());
+		uint64_t writes = obj->stats_.write_count.load(
+			std::memory_order_acquire);
+		if (writes > last_write + 1) {
+			std::fill(bitmap.begin(), bitmap.end(), ~0);
+		}
+		last_write = writes;
+		return true;
+	}
+
+	/** @brief It publishes the frames of several objects (i.e. rgb, depth
+	           and skeleton of the same capture) under one sequence number.
+
+		The frames are copied under the sequence lock of the group, then all
+		the objects are notified. The objects must be single buffered and
+		written only with group_publish, so a reader woken on any of them
+		gets the frames of the same capture with group_read.
+		i.e.
+		  std::vector<SharedGroupFrame> frames = {
+		    SharedGroupFrame(id_rgb, rgb.data, rgb_bytes),
+		    SharedGroupFrame(id_depth, depth.data, depth_bytes) };
+		  shared_data.group_publish("capture", frames, sequence);
+
+		@param[out] sequence Sequence number of the published group.
+		@return It returns false (and nothing is published) if an object is
+		        triple buffered, a frame is too large or a reader holds a
+		        lease on an object.
+	*/
+	bool group_publish(const std::string &name,
+		const std::vector<SharedGroupFrame> &frames, uint64_t &sequence) {
+		SharedSeqlock *lock = smm_.find_or_create_seqlock("group_" + name);
+		if (lock == nullptr) return false;
+		std::vector<size_t> ids;
+		ids.reserve(frames.size());
+		for (auto &it : frames) {
+			SharedObject *obj = smm_.shared_object(it.id);
+			if (obj == nullptr || image_triple_buffer(it.id).is_valid() ||
+				it.bytes > obj->ptr_size()) {
+				std::cout << "Unable to publish the object " << it.id <<
+					" in the group " << name << std::endl;
+				return false;
+			}
+			ids.push_back(it.id);
+		}
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		// leases in order of id, so two groups do not wait each other
+		size_t num_leased = 0;
+		for (; num_leased < ids.size(); ++num_leased) {
+			size_t max_bytes = 0;
+			if (object_acquire_write(ids[num_leased], max_bytes) == nullptr) {
+				break;
+			}
+		}
+		if (num_leased < ids.size()) {
+			for (size_t i = 0; i < num_leased; ++i) {
+				object_release_write(ids[i], false);
+			}
+			return false;
+		}
+
+		lock->write_begin();
+		for (auto &it : frames) {
+			SharedObject *obj = smm_.shared_object(it.id);
+			memcpy(obj->ptr(), it.data, it.bytes);
+			obj->publish(it.bytes);
+		}
+		lock->write_end();
+		sequence = lock->sequence() / 2;
+
+		for (auto id : ids) {
+			smm_.shared_object(id)->lease_state_.fetch_and(~kSharedLeaseWriter,
+				std::memory_order_release);
+		}
+		for (auto id : ids) notify_object(id);
+		return true;
+	}
+
+	/** @brief It copies the frames of a group published by group_publish.
+
+		No lock is held while copying: the copy is repeated if the producer
+		published the group in the meantime, so all the frames belong to
+		the same publication.
+
+		@param[in,out] frames Objects to read. The bytes of each frame is the
+		               size of its data in input, and the size of the frame
+		               copied in output.
+		@param[out] sequence Sequence number of the group read.
+		@return It returns false if an object does not exist or a coherent
+		        copy was not possible in max_retries attempts.
+	*/
+	bool group_read(const std::string &name,
+		std::vector<SharedGroupFrame> &frames, uint64_t &sequence,
+		int max_retries = kSeqlockMaxRetries) {
+		SharedSeqlock *lock = smm_.find_or_create_seqlock("group_" + name);
+		if (lock == nullptr) return false;
+		std::vector<size_t> capacity(frames.size());
+		for (size_t i = 0; i < frames.size(); ++i) {
+			if (smm_.shared_object(frames[i].id) == nullptr) return false;
+			capacity[i] = frames[i].bytes;
+		}
+		for (int retry = 0; retry < max_retries; ++retry) {
+			uint32_t s = lock->read_begin();
+			bool is_consistent = true;
+			for (size_t i = 0; i < frames.size(); ++i) {
+				SharedObject *obj = smm_.shared_object(frames[i].id);
+				// the length under the lock of the header, in the section of
+				// the group
+				SharedObjectHeader header;
+				is_consistent = obj->header(header);
+				if (!is_consistent) break;
+				size_t bytes = (std::min)(static_cast<size_t>(header.length),
+					obj->ptr_size());
+				frames[i].bytes = (std::min)(bytes, capacity[i]);
+				memcpy(frames[i].data, obj->ptr(), frames[i].bytes);
+			}
+			if (is_consistent && !lock->read_retry(s)) {
+				sequence = s / 2;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** @brief It returns true if the state of an object can be taken by
+	           tap_acquire.
+
+		The frame queues (ring, broadcast, pool) are not supported: a copy
+		would take the frames of their consumers.
+	*/
+	bool tap_supported(size_t id_obj) {
+		SharedObject *obj = smm_.shared_object(id_obj);
+		return obj != nullptr && obj->object_type_ != "ring" &&
+			obj->object_type_ != "broadcast" && obj->object_type_ != "pool";
+	}
+
+	/** @brief It takes the state of an object (vectors, string, header of
+	           the last publication) and pins its raw memory, so it can be
+	           sent or copied without an intermediate buffer.
+
+		A triple buffered image returns its last frame published (nullptr
+		if none) without pinning it. The writer writes that frame again only
+		after a new publication, which tap_release detects. The other
+		objects are pinned by a read lease until tap_release.
+		@param[out] record State of the object (the payload is not filled).
+		@param[out] data Raw memory of the object.
+		@param[out] bytes Size of the raw memory.
+		@return It returns false if the object is not supported (see
+		        tap_supported) or a writer holds it.
+	*/
+	bool tap_acquire(size_t id_obj, SharedTapRecord &record,
+		const void* &data, size_t &bytes) {
+		data = nullptr;
+		bytes = 0;
+		if (!tap_supported(id_obj)) return false;
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (!smm_.read_consistent(id_obj, record.int_values,
+			record.double_values)) {
+			return false;
+		}
+		record.id = id_obj;
+		record.text = smm_.object_get_string(id_obj);
+		SharedObjectHeader header;
+		if (is_triple_buffer(id_obj)) {
+			// a lease without a frame: it keeps object_reallocate away
+			uint32_t state = obj->lease_state_.load(std::memory_order_relaxed);
+			do {
+				if (state & kSharedLeaseResize) return false;
+			} while (!obj->lease_state_.compare_exchange_weak(state, state + 1,
+				std::memory_order_acquire, std::memory_order_relaxed));
+			SharedTripleBuffer tb = image_triple_buffer(id_obj);
+			// the frame and the header of the same publication (the writer
+			// commits the frame in the write section of the header)
+			bool is_consistent = false;
+			for (int retry = 0; retry < kSeqlockMaxRetries && !is_consistent;
+				++retry) {
+				uint32_t s = obj->header_lock_.read_begin();
+				header = obj->header_;
+				data = tb.latest_written();
+				is_consistent = !obj->header_lock_.read_retry(s);
+			}
+			if (!is_consistent) {
+				obj->lease_state_.fetch_sub(1, std::memory_order_release);
+				data = nullptr;
+				return false;
+			}
+			record.sequence = header.sequence;
+			record.timestamp_ns = header.timestamp_ns;
+			if (data != nullptr) bytes = tb.buffer_bytes();
+			return true;
+		}
+		data = object_acquire_read(id_obj, bytes);
+		if (data == nullptr) return false;
+		// the lease excludes the writer, so the header is the one of the
+		// memory pinned
+		if (!obj->header(header)) {
+			object_release_read(id_obj, data);
+			data = nullptr;
+			return false;
+		}
+		record.sequence = header.sequence;
+		record.timestamp_ns = header.timestamp_ns;
+		return true;
+	}
+
+	/** @brief It releases the raw memory pinned by tap_acquire.
+
+		@return It returns false if the raw memory may have been modified
+		        while it was pinned (a triple buffered image published a new
+		        frame): its copy must be discarded.
+	*/
+	bool tap_release(const SharedTapRecord &record) {
+		size_t id_obj = static_cast<size_t>(record.id);
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (obj == nullptr) return false;
+		if (is_triple_buffer(id_obj)) {
+			// the copy of the frame happens before the header is read again
+			std::atomic_thread_fence(std::memory_order_acquire);
+			SharedObjectHeader header;
+			bool is_valid = obj->header(header) &&
+				header.sequence == record.sequence;
+			obj->lease_state_.fetch_sub(1, std::memory_order_release);
+			return is_valid;
+		}
+		// only the triple buffered images need the memory to release
+		object_release_read(id_obj, nullptr);
+		return true;
+	}
+
+	/** @brief It copies the state of an object (see tap_acquire), i.e. to
+	           record it in a tap file.
+
+		@return It returns false if the object is a frame queue or a
+		        consistent copy was not possible.
+	*/
+	bool tap_capture(size_t id_obj, SharedTapRecord &record) {
+		if (!tap_supported(id_obj)) return false;
+		for (int retry = 0; retry < kSeqlockMaxRetries; ++retry) {
+			const void *data = nullptr;
+			size_t bytes = 0;
+			if (!tap_acquire(id_obj, record, data, bytes)) {
+				// a writer holds the object
+				std::this_thread::yield();
+				continue;
+			}
+			const char *p = static_cast<const char*>(data);
+			record.payload.assign(p, p + bytes);
+			if (tap_release(record)) return true;
+		}
+		return false;
+	}
+
+	/** @brief It publishes a state copied by tap_capture (i.e. read from a
+	           tap file) and notifies the object.
+	*/
+	bool tap_publish(const SharedTapRecord &record) {
+		size_t id_obj = static_cast<size_t>(record.id);
+		SharedObject *obj = smm_.shared_object(id_obj);
+		if (obj == nullptr) return false;
+		smm_.object_Veci_copyFrom(id_obj, record.int_values.data(),
+			record.int_values.size());
+		smm_.object_Vecd_copyFrom(id_obj, record.double_values.data(),
+			record.double_values.size());
+		if (!record.text.empty()) smm_.object_set_string(id_obj, record.text);
+		if (record.payload.empty()) {
+			obj->publish(record.text.size());
+			notify_object(id_obj);
+			return true;
+		}
+		return image_copyFrom(id_obj, record.payload.data(),
+			record.payload.size());
+	}
+
+	/** @brief It changes the resolution of an image (i.e. the camera
+	           resolution changed) without restarting the processes.
+
+		The content of the image is not preserved.
+	*/
+	bool image_resize(size_t id_obj, int width, int height, int channels) {
+		std::vector<int> int_values;
+		std::vector<double> double_values;
+		if (!smm_.read_consistent(id_obj, int_values, double_values) ||
+			double_values.size() < 3) {
+			return false;
+		}
+		bool is_triple = is_triple_buffer(id_obj);
+		size_t size_byte = static_cast<size_t>(width) * height * channels;
+		size_t bytes = size_byte;
+		if (is_triple) bytes = SharedTripleBuffer::memory_size(size_byte);
+		// the triple buffer is initialized before a reader can pin it
+		if (!smm_.object_reallocate(id_obj, bytes, [&](void *ptr) {
+			if (is_triple) SharedTripleBuffer(ptr).initialize(size_byte);
+		})) {
+			return false;
+		}
+		double_values[0] = width;
+		double_values[1] = height;
+		double_values[2] = channels;
+		smm_.object_Vecd_modify(id_obj, double_values);
+		// the dirty tiles refer to the previous resolution
+		if (int_values.size() > kImageDirtyTileSize) {
+			int_values.resize(kImageDirtyTileSize);
+			smm_.object_Veci_copyFrom(id_obj, int_values.data(),
+				int_values.size());
+		}
+		notify_object(id_obj);
+		return true;
+	}
+
+	/** @brief It changes the maximum number of points of a pcl object.
+
+		The valid points are preserved up to the new maximum.
+	*/
+	bool pcl_resize(size_t id_obj, int num_points) {
+		std::vector<int> int_values;
+		std::vector<double> double_values;
+		if (!smm_.read_consistent(id_obj, int_values, double_values) ||
+			int_values.size() < 2 || int_values[0] <= 0) {
+			return false;
+		}
+		size_t size = 0;
+		smm_.object_get_ptr(id_obj, size);
+		size_t byte4point = size / int_values[0];
+		if (!smm_.object_reallocate(id_obj, byte4point * num_points)) {
+			return false;
+		}
+		int_values[0] = num_points;
+		int_values[1] = (std::min)(int_values[1], num_points);
+		smm_.object_Veci_modify(id_obj, int_values);
+		notify_object(id_obj);
+		return true;
+	}
+
 	/** @brief It gets the size of an associated image
 	*/
 	bool get_image_size(const std::string &object_name, 
@@ -630,6 +1504,44 @@ public:
 
 private:
 
+	/** @brief It makes the objects discoverable: index of the names, layout
+	           (used by a warm restart and a replay) and global and per
+	           object mutex and condition variable.
+	*/
+	void publish_layout(const std::string &msg) {
+		// index of the object names (used by detect)
+		smm_.build_index();
+		// layout of the objects (used by a warm restart and a replay)
+		*smm_.find_or_create_value64("layout_hash") =
+			SharedMemoryManager::hash_name(msg.data(), msg.size());
+		*smm_.find_or_create_string("layout") = msg.c_str();
+
+		// It creates the mutex and condition variable for whole process
+		global_mtx_ =
+			smm_.find_or_create_mutex("global_mtx");
+		global_cnd_ =
+			smm_.find_or_create_condition("global_cnd");
+		global_seq_ =
+			smm_.find_or_create_counter("global_seq");
+
+		// it creates the mutex and condition variable
+		for (size_t i = 0; i < smm_.num_items(); ++i) {
+			std::string name = "obj_mtx" + std::to_string(i);
+			v_obj_mtx_.push_back(
+				smm_.find_or_create_mutex(name.c_str())
+			);
+		}
+		for (size_t i = 0; i < smm_.num_items(); ++i) {
+			std::string name = "obj_cnd" + std::to_string(i);
+			v_obj_cnd_.push_back(
+				smm_.find_or_create_condition(name.c_str())
+			);
+		}
+	}
+
+	/** @brief Readers attached to the broadcast objects (object, reader)
+	*/
+	std::vector<std::pair<size_t, int> > broadcast_readers_;
 };
 
 } // namespace shm
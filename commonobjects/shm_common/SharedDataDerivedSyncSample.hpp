@@ -27,8 +27,6 @@
 
 #include "SharedDataBase.hpp"
 
-#include <windows.h>
-
 namespace co
 {
 namespace shm
@@ -112,6 +110,10 @@ public:
 
 		// parse the request
 		std::vector<std::string> words = co::text::StringOp::split(msg, '|');
+		// bookkeeping of each object (named mutex, condition, allocator) and
+		// padding to align the raw memory
+		memory_buffer += words.size() * (kSharedObjectBookkeepingBytes +
+			2 * memory_options_.alignment);
 		for (auto &it : words) {
 			std::vector<std::string> words2 = co::text::StringOp::split(it, ',');
 			if (words2.size() >= 2) {
@@ -237,9 +239,21 @@ public:
 
 		// Create the memory space
 		if (do_allocate) {
+			// a persistent segment with the same layout keeps its content
+			// (warm restart)
+			if (memory_options_.persistent && detect(name_shm, name_object_shm)) {
+				if (*smm_.find_or_create_value64("layout_hash") ==
+					SharedMemoryManager::hash_name(msg.data(), msg.size())) {
+					std::cout << "Warm restart: " << name_shm << std::endl;
+					smm_.recover();
+					return err;
+				}
+				v_obj_mtx_.clear();
+				v_obj_cnd_.clear();
+			}
 			// create the memory (allocate the necessary space)
 			if (!smm_.create(name_shm_, memory_to_allocate_bytes_ +
-				memory_buffer)) {
+				memory_buffer, memory_options_)) {
 				std::cout << "Unable to create: " << name_shm_ << std::endl;
 				// error
 				return kSharedUnableToCreateSharedMemory;
@@ -249,11 +263,19 @@ public:
 			// parse the string again to instantiate the parameters
 			parse(name_shm, name_object_shm, msg, false);
 		} else {
+			// index of the object names (used by detect)
+			smm_.build_index();
+			// layout of the objects (used by a warm restart)
+			*smm_.find_or_create_value64("layout_hash") =
+				SharedMemoryManager::hash_name(msg.data(), msg.size());
+
 			// It creates the mutex and condition variable for whole process
 			global_mtx_ =
 				smm_.find_or_create_mutex("global_mtx");
 			global_cnd_ =
 				smm_.find_or_create_condition("global_cnd");
+			global_seq_ =
+				smm_.find_or_create_counter("global_seq");
 
 			// it creates the mutex and condition variable
 			for (size_t i = 0; i < smm_.num_items(); ++i) {
@@ -286,7 +308,7 @@ public:
 		// copy the name of the shared memory
 		name_shm_ = name_shm;
 
-		if (!smm_.detect(name_shm_, name_object_shm)) {
+		if (!smm_.detect(name_shm_, name_object_shm, memory_options_)) {
 			std::cout << "Unable to detect: " << name_shm << std::endl;
 			return false;
 		}
@@ -296,6 +318,8 @@ public:
 			smm_.find_or_create_mutex("global_mtx");
 		global_cnd_ =
 			smm_.find_or_create_condition("global_cnd");
+		global_seq_ =
+			smm_.find_or_create_counter("global_seq");
 
 		// It creates the mutex and condition variable for the existing
 		// objects
@@ -319,23 +343,13 @@ public:
 	/** @brief If started from the function "start()" it will run in a
 			   separated thread.
 	*/
-	void process(int thread_priority) {
+	void process(int /*thread_priority*/) {
 		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock{ *global_mtx_ };
 		bool noTimeout = true;
 
 		//Print messages until the other process marks the end
 		size_t num_sources = smm_.num_items();
 
-		switch (thread_priority) {
-		case kThreadPriorityNone:
-			break;
-		case kThreadPriorityBackgroundBegin:
-			// Increase the thread priority
-			SetThreadPriority(GetCurrentThread(),
-				THREAD_MODE_BACKGROUND_BEGIN);
-			break;
-		}
-
 		// image used to close the program
 		bool valid_data = false;
 		do_continue_ = true;
@@ -397,33 +411,40 @@ public:
 	           when event occurrs.
 	*/
 	void process_id(int thread_priority, size_t object_id) {
+		if (notification_mode_ == kNotificationFutex) {
+			process_id_futex(thread_priority, object_id);
+			return;
+		}
 		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock{ *v_obj_mtx_[object_id] };
 		bool noTimeout = true;
 
 		//Print messages until the other process marks the end
 		size_t num_sources = smm_.num_items();
 
-		switch (thread_priority) {
-		case kThreadPriorityNone:
-			break;
-		case kThreadPriorityBackgroundBegin:
-			// Increase the thread priority
-			SetThreadPriority(GetCurrentThread(),
-				THREAD_MODE_BACKGROUND_BEGIN);
-			break;
-		}
-
 		// image used to close the program
 		bool valid_data = false;
+		SharedObject *obj = smm_.shared_object(object_id);
+		uint64_t last_write = obj->stats_.write_count.load(
+			std::memory_order_acquire);
+		uint32_t last = SharedNotifier::load(&obj->notify_seq_);
 		do_continue_ = true;
 		do {
 			//double start = cv::getTickCount();
 			// In normal condition it should be locked
 			v_obj_cnd_[object_id]->notify_all();
 
-			// wait?
-			boost::system_time timeout = boost::get_system_time() + boost::posix_time::milliseconds(kSharedDataProcessTimeout);
-			noTimeout = v_obj_cnd_[object_id]->timed_wait(lock, timeout);
+			// busy polling before the wait (see set_wait_spin)
+			if (SharedNotifier::spin(&obj->notify_seq_, last, wait_spin_ns_)) {
+				noTimeout = true;
+			} else {
+				// wait?
+				boost::system_time timeout = boost::get_system_time() + boost::posix_time::milliseconds(kSharedDataProcessTimeout);
+				noTimeout = v_obj_cnd_[object_id]->timed_wait(lock, timeout);
+				// a notification sent while this thread was not waiting
+				uint32_t current = SharedNotifier::load(&obj->notify_seq_);
+				if (current != last) noTimeout = true;
+				last = current;
+			}
 			// timeout
 			if (!noTimeout)
 			{
@@ -437,8 +458,8 @@ public:
 
 			//std::cout << "<> notify to server" << std::endl;
 			// callback here
-			if (f_callback_ != nullptr && valid_data) {
-				f_callback_(object_id, smm_);
+			if (valid_data) {
+				dispatch_callback(object_id, last_write);
 			}
 			// invalidate the data
 			valid_data = false;
@@ -470,6 +491,29 @@ public:
 	}
 
 
+	/** @brief It process a specific object waiting on the notification
+	           counter of the object (futex backend).
+
+		No mutex is held while waiting or during the callback.
+	*/
+	void process_id_futex(int /*thread_priority*/, size_t object_id) {
+		SharedObject *obj = smm_.shared_object(object_id);
+		if (obj == nullptr) return;
+		uint32_t last = SharedNotifier::load(&obj->notify_seq_);
+		uint64_t last_write = obj->stats_.write_count.load(
+			std::memory_order_acquire);
+
+		do_continue_ = true;
+		do {
+			if (wait_object(object_id, last, kSharedDataProcessTimeout)) {
+				dispatch_callback(object_id, last_write);
+			}
+		} while (do_continue_);
+
+		std::cout << "</SharedDataClient::process>" << std::endl;
+	}
+
+
 	/** @brief It push new data
 
 		It pushes a new data.
@@ -482,8 +526,9 @@ public:
 			id_obj >= 0 && id_obj < smm_.num_items()) {
 			// update
 			smm_.object_set_string(id_obj, msg);
+			smm_.shared_object(id_obj)->publish(msg.size());
 			// notify
-			v_obj_cnd_[id_obj]->notify_all();
+			notify_object(id_obj);
 			//std::unique_lock<std::mutex> lk(c_mutex_);
 			//smm_.set(id_obj, msg);
 			//c_is_ready_ = true;
@@ -498,8 +543,9 @@ public:
 		if (id_obj >= 0 && id_obj < smm_.num_items()) {
 			// update
 			smm_.object_set_string(id_obj, msg);
+			smm_.shared_object(id_obj)->publish(msg.size());
 			// notify
-			v_obj_cnd_[id_obj]->notify_all();
+			notify_object(id_obj);
 			//std::unique_lock<std::mutex> lk(c_mutex_);
 			//smm_.set(id_obj, msg);
 			//c_is_ready_ = true;
@@ -530,7 +576,11 @@ public:
 				auto obj = smm_.shared_object(id_obj);
 				//std::cout << "obj: " << obj << std::endl;
 				if (obj != nullptr) {
-					obj->int_vector_[1] = it.second.num_points;
+					{
+						SharedSeqlockWriteGuard guard(obj->meta_lock_);
+						obj->int_vector_[1] = it.second.num_points;
+					}
+					obj->publish(sizeof(float) * it.second.points_data.size());
 					// sum points
 					//num_points += it.second.num_points;
 					//std::cout << "Obj: " << it.first << " " << id_obj << " " << obj->int_vector_[1] << " " << it.second.num_points << std::endl;
@@ -570,6 +620,10 @@ public:
 
 		if (sync_cnd_.find(who_cnd) == sync_cnd_.end()) {
 			sync_cnd_[who_cnd] = smm_.find_or_create_condition(who_cnd);
+			// counter of the notifications, polled before the wait
+			sync_seq_[who_cnd] = smm_.find_or_create_counter(who_cnd + "_seq");
+			sync_last_[who_cnd] = sync_seq_[who_cnd]->load(
+				std::memory_order_acquire);
 		}
 	}
 
@@ -577,14 +631,19 @@ public:
 	            otherwise.
 	*/
 	bool wait_timeout(const std::string &who_mtx, const std::string &who_cnd, int timeout_ms) {
+		if (spin_wait(who_cnd)) return true;
 		// wait?
 		boost::system_time timeout = boost::get_system_time() + boost::posix_time::milliseconds(timeout_ms);
-		return sync_cnd_[who_cnd]->timed_wait(sync_lock_[who_mtx], timeout);
+		bool notified = sync_cnd_[who_cnd]->timed_wait(sync_lock_[who_mtx], timeout);
+		update_last(who_cnd);
+		return notified;
 	}
 
 	bool wait_no_timeout(const std::string &who_mtx, const std::string &who_cnd) {
+		if (spin_wait(who_cnd)) return true;
 		boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> lock(*sync_mtx_[who_mtx]);
 		sync_cnd_[who_cnd]->wait(lock);
+		update_last(who_cnd);
 
 		return true;
 	}
@@ -605,12 +664,14 @@ public:
 
 	void notify_all(const std::string &who) {
 		if (sync_cnd_.find(who) != sync_cnd_.end()) {
+			sync_seq_[who]->fetch_add(1, std::memory_order_release);
 			sync_cnd_[who]->notify_all();
 		}
 	}
 
 	void notify_one(const std::string &who) {
 		if (sync_cnd_.find(who) != sync_cnd_.end()) {
+			sync_seq_[who]->fetch_add(1, std::memory_order_release);
 			sync_cnd_[who]->notify_one();
 		}
 	}
@@ -618,9 +679,32 @@ public:
 
 private:
 
+	/** @brief It polls the notification counter of a condition before the
+	           wait (see set_wait_spin).
+
+		@return It returns true if a notification arrived.
+	*/
+	bool spin_wait(const std::string &who_cnd) {
+		auto it = sync_seq_.find(who_cnd);
+		if (it == sync_seq_.end()) return false;
+		return SharedNotifier::spin(it->second, sync_last_[who_cnd],
+			wait_spin_ns_);
+	}
+
+	/** @brief It sets the notifications of a condition as seen
+	*/
+	void update_last(const std::string &who_cnd) {
+		auto it = sync_seq_.find(who_cnd);
+		if (it != sync_seq_.end()) {
+			sync_last_[who_cnd] = it->second->load(std::memory_order_acquire);
+		}
+	}
+
 	std::map<std::string, boost::interprocess::interprocess_mutex*> sync_mtx_;
 	std::map<std::string, boost::interprocess::interprocess_condition*> sync_cnd_;
 	std::map<std::string, int> sync_timeout_ms_;
+	std::map<std::string, std::atomic<uint32_t>*> sync_seq_;
+	std::map<std::string, uint32_t> sync_last_;
 	std::map<std::string, boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex>> sync_lock_;
 };
 
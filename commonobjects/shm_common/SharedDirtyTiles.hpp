@@ -0,0 +1,183 @@
+/**
+* @file SharedDirtyTiles.hpp
+* @brief Tile based difference of two images, to copy only the changed
+*        regions in the shared memory.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDDIRTYTILES_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDDIRTYTILES_HPP__
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CO_SHM_DIRTY_TILES_SSE2
+#endif
+
+namespace co
+{
+namespace shm
+{
+
+// Default side of a tile (pixels)
+const int kSharedDirtyTileSize = 64;
+// Bits of a word of the dirty bitmap
+const int kSharedDirtyBitsWord = 32;
+
+/** @brief Difference of two images in square tiles.
+
+	The dirty bitmap has a bit for each tile (row major), packed in words of
+	32 bits. The words are int, so the bitmap can be saved in the int vector
+	of an object.
+*/
+class SharedDirtyTiles
+{
+public:
+
+	/** @brief Number of tiles of an image
+	*/
+	static size_t num_tiles(int width, int height, int tile_size) {
+		return static_cast<size_t>((width + tile_size - 1) / tile_size) *
+			((height + tile_size - 1) / tile_size);
+	}
+
+	/** @brief Number of words of the dirty bitmap of an image
+	*/
+	static size_t bitmap_words(int width, int height, int tile_size) {
+		return (num_tiles(width, height, tile_size) + kSharedDirtyBitsWord - 1) /
+			kSharedDirtyBitsWord;
+	}
+
+	/** @brief It returns true if a tile is set in the dirty bitmap
+	*/
+	static bool is_dirty(const int *bitmap, size_t tile) {
+		return (static_cast<uint32_t>(bitmap[tile / kSharedDirtyBitsWord]) >>
+			(tile % kSharedDirtyBitsWord)) & 1;
+	}
+
+	/** @brief It returns true if two memory areas have the same content
+	*/
+	static bool equal(const uint8_t *a, const uint8_t *b, size_t bytes) {
+		size_t i = 0;
+#if defined(CO_SHM_DIRTY_TILES_SSE2)
+		for (; i + 64 <= bytes; i += 64) {
+			__m128i c0 = _mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+			__m128i c1 = _mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16)));
+			__m128i c2 = _mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 32)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 32)));
+			__m128i c3 = _mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 48)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 48)));
+			__m128i c = _mm_and_si128(_mm_and_si128(c0, c1),
+				_mm_and_si128(c2, c3));
+			if (_mm_movemask_epi8(c) != 0xFFFF) return false;
+		}
+		for (; i + 16 <= bytes; i += 16) {
+			__m128i c = _mm_cmpeq_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+			if (_mm_movemask_epi8(c) != 0xFFFF) return false;
+		}
+#endif
+		return i == bytes || memcmp(a + i, b + i, bytes - i) == 0;
+	}
+
+	/** @brief It copies the tiles of src that changed.
+
+		@param[in,out] dst Image to update.
+		@param[in] reference Previous frame, used to build the dirty bitmap.
+		           It may be dst (the tiles are copied only if dirty) or
+		           nullptr (all the tiles are dirty).
+		@param[in] src New frame.
+		@param[out] bitmap Dirty bitmap of src compared to reference.
+		@param[out] bytes_copied Bytes copied in dst.
+		@return It returns the number of dirty tiles.
+	*/
+	static size_t copy(uint8_t *dst, const uint8_t *reference,
+		const uint8_t *src, int width, int height, int channels,
+		int tile_size, std::vector<int> &bitmap, size_t &bytes_copied) {
+		bitmap.assign(bitmap_words(width, height, tile_size), 0);
+		bytes_copied = 0;
+		size_t num_dirty = 0;
+		size_t stride = static_cast<size_t>(width) * channels;
+		size_t tiles_x = (width + tile_size - 1) / tile_size;
+		size_t tile_bytes = static_cast<size_t>(tile_size) * channels;
+		std::vector<char> dirty(tiles_x), do_copy(tiles_x);
+		size_t tile = 0;
+		for (int y0 = 0; y0 < height; y0 += tile_size, tile += tiles_x) {
+			int rows = (std::min)(tile_size, height - y0);
+			std::fill(dirty.begin(), dirty.end(), reference == nullptr);
+			std::fill(do_copy.begin(), do_copy.end(), reference == nullptr);
+			// the rows are compared in memory order
+			for (int r = 0; r < rows; ++r) {
+				size_t first = (y0 + r) * stride;
+				// most of the rows of a static scene do not change
+				if (reference == dst && reference != nullptr &&
+					equal(reference + first, src + first, stride)) {
+					continue;
+				}
+				for (size_t x = 0; x < tiles_x; ++x) {
+					size_t begin = first + x * tile_bytes;
+					size_t bytes = (std::min)(tile_bytes, first + stride - begin);
+					if (!dirty[x] &&
+						!equal(reference + begin, src + begin, bytes)) {
+						dirty[x] = 1;
+					}
+					if (!do_copy[x] && (dirty[x] || (reference != dst &&
+						!equal(dst + begin, src + begin, bytes)))) {
+						do_copy[x] = 1;
+					}
+				}
+			}
+			for (size_t x = 0; x < tiles_x; ++x) {
+				if (dirty[x]) {
+					size_t t = tile + x;
+					bitmap[t / kSharedDirtyBitsWord] |=
+						static_cast<int>(1u << (t % kSharedDirtyBitsWord));
+					++num_dirty;
+				}
+				if (!do_copy[x]) continue;
+				size_t begin = y0 * stride + x * tile_bytes;
+				size_t bytes = (std::min)(tile_bytes, stride - x * tile_bytes);
+				for (int r = 0; r < rows; ++r) {
+					memcpy(dst + begin + r * stride, src + begin + r * stride,
+						bytes);
+				}
+				bytes_copied += rows * bytes;
+			}
+		}
+		return num_dirty;
+	}
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDDIRTYTILES_HPP__
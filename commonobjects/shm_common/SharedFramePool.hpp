@@ -0,0 +1,326 @@
+/**
+* @file SharedFramePool.hpp
+* @brief Pool of reference counted frames shared among processes.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDFRAMEPOOL_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDFRAMEPOOL_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "SharedFrameRing.hpp"
+
+namespace co
+{
+namespace shm
+{
+
+// Magic number written in an initialized frame pool header
+const uint32_t kSharedFramePoolMagic = 0x504f4f4c; // "POOL"
+
+// Handle of a frame: (generation << 32) | slot index.
+// The generation of an allocated slot is never 0.
+typedef uint64_t SharedFrameHandle;
+const SharedFrameHandle kSharedFrameInvalidHandle = 0;
+
+/** @brief Header of the frame pool. It lives at the beginning of the raw
+           memory of the shared object, followed by the queue of the
+           published handles and the slots.
+*/
+struct SharedFramePoolHeader
+{
+	/** @brief Number of handles published
+	*/
+	std::atomic<uint64_t> publish_seq;
+	char pad_publish[kSharedCacheLineBytes - sizeof(std::atomic<uint64_t>)];
+	uint32_t magic;
+	uint32_t reserved;
+	uint64_t slot_bytes;
+	uint64_t num_slots;
+	uint64_t slot_stride;
+	uint64_t queue_size;
+	char pad_info[kSharedCacheLineBytes - 5 * sizeof(uint64_t)];
+};
+
+/** @brief Header of a slot. The frame follows the header.
+*/
+struct SharedFramePoolSlot
+{
+	/** @brief (generation << 32) | number of references
+	*/
+	std::atomic<uint64_t> state;
+	uint64_t bytes;
+	char pad[kSharedCacheLineBytes - 2 * sizeof(uint64_t)];
+};
+
+/** @brief View over a pool of frames allocated in the shared memory.
+
+	A producer allocates a free slot, fills it and publishes its handle in
+	a small queue. Any process can take a reference to a published frame
+	and keep it without copying: the slot is reused only when the last
+	reference is released. The generation in the handle detects a slot
+	reused in the meantime.
+	A process that terminates while holding a reference keeps the slot
+	busy until the pool is created again.
+*/
+class SharedFramePool
+{
+public:
+
+	SharedFramePool() : header_(nullptr) {}
+
+	explicit SharedFramePool(void *ptr) :
+		header_(static_cast<SharedFramePoolHeader*>(ptr)) {}
+
+	/** @brief It returns the bytes necessary to allocate a pool.
+	*/
+	static constexpr size_t memory_size(size_t slot_bytes, size_t num_slots,
+		size_t queue_size) {
+		return sizeof(SharedFramePoolHeader) + queue_bytes(queue_size) +
+			num_slots * slot_stride(slot_bytes);
+	}
+
+	/** @brief It returns the distance in bytes between two slots.
+	*/
+	static constexpr size_t slot_stride(size_t slot_bytes) {
+		return (sizeof(SharedFramePoolSlot) + slot_bytes +
+			kSharedCacheLineBytes - 1) /
+			kSharedCacheLineBytes * kSharedCacheLineBytes;
+	}
+
+	/** @brief It initializes the pool. It must be called only once by the
+	           process that allocates the memory.
+	*/
+	void initialize(size_t slot_bytes, size_t num_slots, size_t queue_size) {
+		if (header_ == nullptr) return;
+		new (&header_->publish_seq) std::atomic<uint64_t>(0);
+		header_->reserved = 0;
+		header_->slot_bytes = slot_bytes;
+		header_->num_slots = num_slots;
+		header_->slot_stride = slot_stride(slot_bytes);
+		header_->queue_size = queue_size;
+		for (size_t i = 0; i < queue_size; ++i) {
+			new (&queue()[i]) std::atomic<uint64_t>(kSharedFrameInvalidHandle);
+		}
+		for (size_t i = 0; i < num_slots; ++i) {
+			new (&slot(i)->state) std::atomic<uint64_t>(0);
+			slot(i)->bytes = 0;
+		}
+		header_->magic = kSharedFramePoolMagic;
+	}
+
+	/** @brief It returns true if the memory contains an initialized pool.
+	*/
+	bool is_valid() const {
+		return header_ != nullptr && header_->magic == kSharedFramePoolMagic &&
+			header_->num_slots > 0 && header_->queue_size > 0;
+	}
+
+	/** @brief Maximum size of a frame (bytes)
+	*/
+	size_t slot_bytes() const {
+		return is_valid() ? static_cast<size_t>(header_->slot_bytes) : 0;
+	}
+
+	/** @brief Number of slots not referenced by anybody
+	*/
+	size_t num_free() const {
+		if (!is_valid()) return 0;
+		size_t n = 0;
+		for (size_t i = 0; i < header_->num_slots; ++i) {
+			if ((slot(i)->state.load(std::memory_order_relaxed) &
+				0xffffffff) == 0) ++n;
+		}
+		return n;
+	}
+
+	/** @brief Producer. It takes a free slot with one reference owned by
+	           the caller.
+
+		@return The handle or kSharedFrameInvalidHandle if all the slots
+		        are referenced.
+	*/
+	SharedFrameHandle allocate() {
+		if (!is_valid()) return kSharedFrameInvalidHandle;
+		for (size_t i = 0; i < header_->num_slots; ++i) {
+			SharedFramePoolSlot *sl = slot(i);
+			uint64_t state = sl->state.load(std::memory_order_relaxed);
+			if ((state & 0xffffffff) != 0) continue;
+			uint32_t gen = static_cast<uint32_t>(state >> 32) + 1;
+			if (gen == 0) gen = 1;
+			uint64_t desired = (static_cast<uint64_t>(gen) << 32) | 1;
+			if (sl->state.compare_exchange_strong(state, desired,
+				std::memory_order_acquire, std::memory_order_relaxed)) {
+				sl->bytes = 0;
+				return (static_cast<uint64_t>(gen) << 32) | i;
+			}
+		}
+		return kSharedFrameInvalidHandle;
+	}
+
+	/** @brief It takes one more reference to a frame.
+
+		@return It returns false if the slot was released and reused.
+	*/
+	bool retain(SharedFrameHandle handle) {
+		SharedFramePoolSlot *sl = slot_of(handle);
+		if (sl == nullptr) return false;
+		uint64_t gen = handle >> 32;
+		uint64_t state = sl->state.load(std::memory_order_relaxed);
+		for (;;) {
+			if ((state >> 32) != gen || (state & 0xffffffff) == 0) return false;
+			if (sl->state.compare_exchange_weak(state, state + 1,
+				std::memory_order_acquire, std::memory_order_relaxed)) {
+				return true;
+			}
+		}
+	}
+
+	/** @brief It releases a reference. The slot is free when the last
+	           reference is released.
+	*/
+	void release(SharedFrameHandle handle) {
+		SharedFramePoolSlot *sl = slot_of(handle);
+		if (sl == nullptr) return;
+		sl->state.fetch_sub(1, std::memory_order_release);
+	}
+
+	/** @brief Memory of a frame. The caller must hold a reference.
+	*/
+	void* data(SharedFrameHandle handle) const {
+		SharedFramePoolSlot *sl = slot_of(handle);
+		if (sl == nullptr) return nullptr;
+		return reinterpret_cast<char*>(sl) + sizeof(SharedFramePoolSlot);
+	}
+
+	/** @brief Number of valid bytes of a frame
+	*/
+	size_t bytes(SharedFrameHandle handle) const {
+		SharedFramePoolSlot *sl = slot_of(handle);
+		return sl != nullptr ? static_cast<size_t>(sl->bytes) : 0;
+	}
+
+	/** @brief Producer. It sets the number of valid bytes of a frame.
+	*/
+	void set_bytes(SharedFrameHandle handle, size_t bytes) {
+		SharedFramePoolSlot *sl = slot_of(handle);
+		if (sl != nullptr && bytes <= header_->slot_bytes) sl->bytes = bytes;
+	}
+
+	/** @brief Producer. It publishes a frame in the queue.
+
+		The reference of the caller is moved to the queue. The reference
+		of the oldest handle in the queue is released.
+	*/
+	bool publish(SharedFrameHandle handle) {
+		if (slot_of(handle) == nullptr) return false;
+		uint64_t s = header_->publish_seq.load(std::memory_order_relaxed);
+		SharedFrameHandle old = queue()[s % header_->queue_size].exchange(
+			handle, std::memory_order_acq_rel);
+		header_->publish_seq.store(s + 1, std::memory_order_release);
+		if (old != kSharedFrameInvalidHandle) release(old);
+		return true;
+	}
+
+	/** @brief Number of handles published
+	*/
+	uint64_t publish_sequence() const {
+		return is_valid() ?
+			header_->publish_seq.load(std::memory_order_acquire) : 0;
+	}
+
+	/** @brief Consumer. It takes a reference to the next published frame.
+
+		@param[in,out] cursor Sequence of the next handle to read (owned by
+		               the consumer, start from publish_sequence()).
+		@return The handle (to release) or kSharedFrameInvalidHandle if
+		        there is no new frame.
+	*/
+	SharedFrameHandle acquire_next(uint64_t &cursor) {
+		if (!is_valid()) return kSharedFrameInvalidHandle;
+		for (;;) {
+			uint64_t w = header_->publish_seq.load(std::memory_order_acquire);
+			if (cursor >= w) return kSharedFrameInvalidHandle;
+			// the oldest handles left the queue
+			if (w - cursor > header_->queue_size) {
+				cursor = w - header_->queue_size;
+			}
+			SharedFrameHandle handle = queue()[cursor % header_->queue_size].load(
+				std::memory_order_acquire);
+			++cursor;
+			if (retain(handle)) return handle;
+		}
+	}
+
+	/** @brief Consumer. It takes a reference to the most recent frame.
+	*/
+	SharedFrameHandle acquire_latest() {
+		uint64_t w = publish_sequence();
+		if (w == 0) return kSharedFrameInvalidHandle;
+		uint64_t cursor = w - 1;
+		return acquire_next(cursor);
+	}
+
+private:
+
+	/** @brief Bytes of the queue of handles
+	*/
+	static constexpr size_t queue_bytes(size_t queue_size) {
+		return (queue_size * sizeof(std::atomic<uint64_t>) +
+			kSharedCacheLineBytes - 1) /
+			kSharedCacheLineBytes * kSharedCacheLineBytes;
+	}
+
+	/** @brief Queue of the published handles
+	*/
+	std::atomic<uint64_t>* queue() const {
+		return reinterpret_cast<std::atomic<uint64_t>*>(
+			reinterpret_cast<char*>(header_) + sizeof(SharedFramePoolHeader));
+	}
+
+	/** @brief It returns a slot given its index
+	*/
+	SharedFramePoolSlot* slot(uint64_t index) const {
+		return reinterpret_cast<SharedFramePoolSlot*>(
+			reinterpret_cast<char*>(header_) + sizeof(SharedFramePoolHeader) +
+			queue_bytes(header_->queue_size) + index * header_->slot_stride);
+	}
+
+	/** @brief It returns the slot of a handle (nullptr if not valid)
+	*/
+	SharedFramePoolSlot* slot_of(SharedFrameHandle handle) const {
+		if (!is_valid() || (handle >> 32) == 0) return nullptr;
+		uint64_t index = handle & 0xffffffff;
+		if (index >= header_->num_slots) return nullptr;
+		return slot(index);
+	}
+
+	/** @brief Header of the pool in the shared memory
+	*/
+	SharedFramePoolHeader *header_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDFRAMEPOOL_HPP__
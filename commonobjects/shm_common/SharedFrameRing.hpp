@@ -0,0 +1,247 @@
+/**
+* @file SharedFrameRing.hpp
+* @brief Lock-free single producer/single consumer ring of frame slots.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDFRAMERING_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDFRAMERING_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+namespace co
+{
+namespace shm
+{
+
+// Size of a cache line (bytes). Used to keep the producer and consumer
+// indexes on separate lines.
+const size_t kSharedCacheLineBytes = 64;
+
+// Magic number written in an initialized ring header
+const uint32_t kSharedFrameRingMagic = 0x52494e47; // "RING"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+	"The frame ring requires lock-free 64 bits atomics (address free).");
+
+/** @brief Header of the ring. It lives at the beginning of the raw memory
+           of the shared object.
+
+	head is only written by the producer, tail only by the consumer.
+*/
+struct SharedFrameRingHeader
+{
+	std::atomic<uint64_t> head;
+	char pad_head[kSharedCacheLineBytes - sizeof(std::atomic<uint64_t>)];
+	std::atomic<uint64_t> tail;
+	char pad_tail[kSharedCacheLineBytes - sizeof(std::atomic<uint64_t>)];
+	uint32_t magic;
+	uint32_t reserved;
+	uint64_t slot_bytes;
+	uint64_t num_slots;
+	uint64_t slot_stride;
+	char pad_info[kSharedCacheLineBytes - 4 * sizeof(uint64_t)];
+};
+
+/** @brief Header of each slot. The payload follows the header.
+*/
+struct SharedFrameRingSlot
+{
+	/** @brief Number of valid bytes in the slot
+	*/
+	uint64_t bytes;
+	char pad[kSharedCacheLineBytes - sizeof(uint64_t)];
+};
+
+/** @brief View over a ring of frame slots allocated in the shared memory.
+
+	The class does not own the memory. It interprets the raw memory of a
+	shared object as a ring of num_slots frames of slot_bytes each.
+	A single producer writes the frames and a single consumer reads them
+	without any mutex. A frame under reading is never overwritten: if the
+	ring is full the producer is informed and the frame is dropped.
+*/
+class SharedFrameRing
+{
+public:
+
+	SharedFrameRing() : header_(nullptr) {}
+
+	explicit SharedFrameRing(void *ptr) :
+		header_(static_cast<SharedFrameRingHeader*>(ptr)) {}
+
+	/** @brief It returns the bytes necessary to allocate a ring.
+	*/
+	static constexpr size_t memory_size(size_t slot_bytes, size_t num_slots) {
+		return sizeof(SharedFrameRingHeader) +
+			num_slots * slot_stride(slot_bytes);
+	}
+
+	/** @brief It returns the distance in bytes between two slots.
+	*/
+	static constexpr size_t slot_stride(size_t slot_bytes) {
+		return (sizeof(SharedFrameRingSlot) + slot_bytes +
+			kSharedCacheLineBytes - 1) /
+			kSharedCacheLineBytes * kSharedCacheLineBytes;
+	}
+
+	/** @brief It initializes the ring. It must be called only once by the
+	           process that allocates the memory.
+	*/
+	void initialize(size_t slot_bytes, size_t num_slots) {
+		if (header_ == nullptr) return;
+		new (&header_->head) std::atomic<uint64_t>(0);
+		new (&header_->tail) std::atomic<uint64_t>(0);
+		header_->slot_bytes = slot_bytes;
+		header_->num_slots = num_slots;
+		header_->slot_stride = slot_stride(slot_bytes);
+		header_->reserved = 0;
+		header_->magic = kSharedFrameRingMagic;
+	}
+
+	/** @brief It returns true if the memory contains an initialized ring.
+	*/
+	bool is_valid() const {
+		return header_ != nullptr && header_->magic == kSharedFrameRingMagic &&
+			header_->num_slots > 0;
+	}
+
+	/** @brief Maximum size of a frame (bytes)
+	*/
+	size_t slot_bytes() const {
+		return is_valid() ? static_cast<size_t>(header_->slot_bytes) : 0;
+	}
+
+	/** @brief Number of slots
+	*/
+	size_t num_slots() const {
+		return is_valid() ? static_cast<size_t>(header_->num_slots) : 0;
+	}
+
+	/** @brief Number of frames ready to be read
+	*/
+	size_t size() const {
+		if (!is_valid()) return 0;
+		return static_cast<size_t>(
+			header_->head.load(std::memory_order_acquire) -
+			header_->tail.load(std::memory_order_acquire));
+	}
+
+	/** @brief Producer. It returns the memory of the next free slot.
+
+		@param[out] max_bytes Size of the available memory.
+		@return The pointer to the slot memory or nullptr if the ring is full.
+	*/
+	void* begin_write(size_t &max_bytes) {
+		max_bytes = 0;
+		if (!is_valid()) return nullptr;
+		uint64_t head = header_->head.load(std::memory_order_relaxed);
+		uint64_t tail = header_->tail.load(std::memory_order_acquire);
+		if (head - tail >= header_->num_slots) return nullptr;
+		max_bytes = static_cast<size_t>(header_->slot_bytes);
+		return slot(head) + sizeof(SharedFrameRingSlot);
+	}
+
+	/** @brief Producer. It publishes the slot obtained with begin_write.
+
+		@param[in] bytes Number of valid bytes written in the slot.
+	*/
+	void commit_write(size_t bytes) {
+		uint64_t head = header_->head.load(std::memory_order_relaxed);
+		reinterpret_cast<SharedFrameRingSlot*>(slot(head))->bytes = bytes;
+		header_->head.store(head + 1, std::memory_order_release);
+	}
+
+	/** @brief Producer. It copies a frame in the ring.
+
+		@return It returns false if the ring is full or the frame too large.
+	*/
+	bool push(const void *data, size_t bytes) {
+		size_t max_bytes = 0;
+		void *ptr = begin_write(max_bytes);
+		if (ptr == nullptr || bytes > max_bytes) return false;
+		memcpy(ptr, data, bytes);
+		commit_write(bytes);
+		return true;
+	}
+
+	/** @brief Consumer. It returns the oldest frame without copying it.
+
+		The memory is valid until pop is called.
+		@param[out] bytes Number of valid bytes of the frame.
+		@return The pointer to the frame or nullptr if the ring is empty.
+	*/
+	const void* front(size_t &bytes) const {
+		bytes = 0;
+		if (!is_valid()) return nullptr;
+		uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+		uint64_t head = header_->head.load(std::memory_order_acquire);
+		if (tail == head) return nullptr;
+		const char *s = slot(tail);
+		bytes = static_cast<size_t>(
+			reinterpret_cast<const SharedFrameRingSlot*>(s)->bytes);
+		return s + sizeof(SharedFrameRingSlot);
+	}
+
+	/** @brief Consumer. It releases the oldest frame.
+	*/
+	void pop() {
+		if (!is_valid()) return;
+		uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+		if (tail == header_->head.load(std::memory_order_acquire)) return;
+		header_->tail.store(tail + 1, std::memory_order_release);
+	}
+
+	/** @brief Consumer. It copies the oldest frame and releases it.
+
+		@param[out] bytes Number of bytes copied.
+		@return It returns false if the ring is empty or the frame does not
+		        fit in max_bytes.
+	*/
+	bool pop(void *data, size_t max_bytes, size_t &bytes) {
+		const void *ptr = front(bytes);
+		if (ptr == nullptr || bytes > max_bytes) return false;
+		memcpy(data, ptr, bytes);
+		pop();
+		return true;
+	}
+
+private:
+
+	/** @brief It returns the memory of a slot given a sequence index
+	*/
+	char* slot(uint64_t index) const {
+		return reinterpret_cast<char*>(header_) +
+			sizeof(SharedFrameRingHeader) +
+			(index % header_->num_slots) * header_->slot_stride;
+	}
+
+	/** @brief Header of the ring in the shared memory
+	*/
+	SharedFrameRingHeader *header_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDFRAMERING_HPP__
@@ -0,0 +1,196 @@
+/**
+* @file SharedMatLease.hpp
+* @brief cv::Mat views over the shared images, protected by a lease.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDMATLEASE_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDMATLEASE_HPP__
+
+#include <opencv2/core/core.hpp>
+
+#include "SharedDataBase.hpp"
+
+namespace co
+{
+namespace shm
+{
+
+/** @brief Read lease of a shared image.
+
+	The cv::Mat is a header directly over the shared memory (no copy), with
+	the size in double_vector_ (width, height, channels). The memory is not
+	modified until the lease is released (destructor or release()).
+	Example:
+	{
+		co::shm::SharedMatReadLease lease(shared_data, key_image);
+		if (lease.is_valid()) cv::imshow("rgb", lease.mat());
+	}
+*/
+class SharedMatReadLease
+{
+public:
+
+	SharedMatReadLease(SharedDataBase &shared_data, size_t id_obj) :
+		shared_data_(shared_data), id_obj_(id_obj), is_valid_(false),
+		ptr_(nullptr) {
+		size_t bytes = 0;
+		const void *ptr = shared_data_.object_acquire_read(id_obj_, bytes);
+		if (ptr == nullptr) return;
+		ptr_ = ptr;
+		is_valid_ = true;
+		int cols = 0, rows = 0, channels = 0;
+		if (!image_size(shared_data_.smm(), id_obj_, cols, rows, channels) ||
+			static_cast<size_t>(cols) * rows * channels > bytes) {
+			release();
+			return;
+		}
+		mat_ = cv::Mat(rows, cols, CV_8UC(channels), const_cast<void*>(ptr));
+	}
+
+	~SharedMatReadLease() {
+		release();
+	}
+
+	/** @brief It returns true if the lease has been acquired
+	*/
+	bool is_valid() const {
+		return is_valid_;
+	}
+
+	/** @brief Image over the shared memory. It must not be modified.
+	*/
+	const cv::Mat& mat() const {
+		return mat_;
+	}
+
+	/** @brief It releases the lease. The image is no more valid.
+	*/
+	void release() {
+		if (!is_valid_) return;
+		mat_ = cv::Mat();
+		shared_data_.object_release_read(id_obj_, ptr_);
+		ptr_ = nullptr;
+		is_valid_ = false;
+	}
+
+	/** @brief It reads the image size from the object information.
+	*/
+	static bool image_size(SharedMemoryManager &smm, size_t id_obj,
+		int &cols, int &rows, int &channels) {
+		double info[3];
+		if (!smm.read_consistent(id_obj, 0, 0, nullptr, 0, 3, info)) {
+			return false;
+		}
+		cols = static_cast<int>(info[0]);
+		rows = static_cast<int>(info[1]);
+		channels = static_cast<int>(info[2]);
+		return cols > 0 && rows > 0 && channels > 0 && channels <= CV_CN_MAX;
+	}
+
+private:
+
+	SharedMatReadLease(const SharedMatReadLease&);
+	SharedMatReadLease& operator=(const SharedMatReadLease&);
+
+	SharedDataBase &shared_data_;
+	size_t id_obj_;
+	bool is_valid_;
+	const void *ptr_;
+	cv::Mat mat_;
+};
+
+
+/** @brief Write lease of a shared image.
+
+	The producer fills the cv::Mat in place. The image is published and the
+	consumers notified when the lease is released, unless cancel() is called.
+*/
+class SharedMatWriteLease
+{
+public:
+
+	SharedMatWriteLease(SharedDataBase &shared_data, size_t id_obj) :
+		shared_data_(shared_data), id_obj_(id_obj), is_valid_(false),
+		do_publish_(true) {
+		size_t bytes = 0;
+		void *ptr = shared_data_.object_acquire_write(id_obj_, bytes);
+		if (ptr == nullptr) return;
+		is_valid_ = true;
+		int cols = 0, rows = 0, channels = 0;
+		if (!SharedMatReadLease::image_size(shared_data_.smm(), id_obj_, 
+			cols, rows, channels) ||
+			static_cast<size_t>(cols) * rows * channels > bytes) {
+			cancel();
+			release();
+			return;
+		}
+		mat_ = cv::Mat(rows, cols, CV_8UC(channels), ptr);
+	}
+
+	~SharedMatWriteLease() {
+		release();
+	}
+
+	/** @brief It returns true if the lease has been acquired
+	*/
+	bool is_valid() const {
+		return is_valid_;
+	}
+
+	/** @brief Image over the shared memory to fill.
+
+		The header must not be reallocated (i.e. use copyTo, not operator=).
+	*/
+	cv::Mat& mat() {
+		return mat_;
+	}
+
+	/** @brief The image will not be published on release
+	*/
+	void cancel() {
+		do_publish_ = false;
+	}
+
+	/** @brief It releases the lease and publishes the image.
+	*/
+	void release() {
+		if (!is_valid_) return;
+		mat_ = cv::Mat();
+		shared_data_.object_release_write(id_obj_, do_publish_);
+		is_valid_ = false;
+	}
+
+private:
+
+	SharedMatWriteLease(const SharedMatWriteLease&);
+	SharedMatWriteLease& operator=(const SharedMatWriteLease&);
+
+	SharedDataBase &shared_data_;
+	size_t id_obj_;
+	bool is_valid_;
+	bool do_publish_;
+	cv::Mat mat_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDMATLEASE_HPP__
@@ -0,0 +1,195 @@
+/**
+* @file SharedNotifier.hpp
+* @brief Notification primitives based on a word in the shared memory.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDNOTIFIER_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDNOTIFIER_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#include <climits>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+	defined(_M_IX86)
+#include <immintrin.h>
+#define CO_SHM_NOTIFIER_PAUSE() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define CO_SHM_NOTIFIER_PAUSE() __asm__ __volatile__("yield")
+#else
+#define CO_SHM_NOTIFIER_PAUSE()
+#endif
+
+namespace co
+{
+namespace shm
+{
+
+// Notification backend used by a process to wait for an object.
+// The producer always notifies every backend.
+const int kNotificationCondition = 0;
+const int kNotificationFutex = 1;
+
+// The waiter blocks immediately (no busy polling before the wait)
+const int64_t kSharedSpinNone = 0;
+// Iterations of the busy polling between two reads of the clock
+const int kSharedSpinClockIterations = 64;
+
+// Bit of the counter set by a thread blocked in the kernel (futex)
+const uint32_t kSharedNotifierWaiters = 0x80000000;
+// Bits of the counter that count the notifications
+const uint32_t kSharedNotifierCount = 0x7FFFFFFF;
+
+/** @brief Wait and wake on a 32 bits counter placed in the shared memory.
+
+	On Linux it uses a (not private) futex on the counter, so that the
+	kernel wakes waiters of any process mapping the segment. A waiter sets
+	kSharedNotifierWaiters before it blocks, and the producer calls the
+	kernel only when the bit is set.
+*/
+class SharedNotifier
+{
+public:
+
+	/** @brief It returns true if the futex backend is available.
+	*/
+	static bool is_futex_available() {
+#if defined(__linux__)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/** @brief It increments the counter and wakes all the waiters.
+
+		The futex is woken only if a waiter is blocked, so a publication
+		without blocked waiters does not call the kernel.
+	*/
+	static void notify_all(std::atomic<uint32_t> *word) {
+		uint32_t old = word->load(std::memory_order_relaxed);
+		while (!word->compare_exchange_weak(old,
+			(old + 1) & kSharedNotifierCount, std::memory_order_release,
+			std::memory_order_relaxed)) {
+		}
+#if defined(__linux__)
+		if (old & kSharedNotifierWaiters) {
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE,
+				INT_MAX, nullptr, nullptr, 0);
+		}
+#endif
+	}
+
+	/** @brief It returns the number of notifications of the counter
+	           (without the waiters bit).
+	*/
+	static uint32_t load(const std::atomic<uint32_t> *word) {
+		return word->load(std::memory_order_acquire) & kSharedNotifierCount;
+	}
+
+	/** @brief It hints the CPU that the thread is busy polling
+	*/
+	static void cpu_relax() {
+		CO_SHM_NOTIFIER_PAUSE();
+	}
+
+	/** @brief It polls the counter until it is different from last, for at
+	           most spin_ns nanoseconds. It does not call the kernel.
+
+		@param[in,out] last Last counter observed. It is updated on change.
+		@return It returns true if the counter changed.
+	*/
+	static bool spin(const std::atomic<uint32_t> *word, uint32_t &last,
+		int64_t spin_ns) {
+		if (spin_ns <= kSharedSpinNone) return false;
+		auto deadline = std::chrono::steady_clock::now() +
+			std::chrono::nanoseconds(spin_ns);
+		for (;;) {
+			for (int i = 0; i < kSharedSpinClockIterations; ++i) {
+				uint32_t current = load(word);
+				if (current != (last & kSharedNotifierCount)) {
+					last = current;
+					return true;
+				}
+				cpu_relax();
+			}
+			if (std::chrono::steady_clock::now() >= deadline) return false;
+		}
+	}
+
+	/** @brief It waits until the counter is different from last.
+
+		@param[in,out] last Last counter observed. It is updated on wake up.
+		@param[in] timeout_ms Maximum time to wait (ms).
+		@param[in] spin_ns Time of busy polling before blocking (ns).
+		@return It returns true if the counter changed, false on timeout.
+	*/
+	static bool wait(std::atomic<uint32_t> *word, uint32_t &last,
+		int timeout_ms, int64_t spin_ns = kSharedSpinNone) {
+		if (spin(word, last, spin_ns)) return true;
+		auto deadline = std::chrono::steady_clock::now() +
+			std::chrono::milliseconds(timeout_ms);
+		for (;;) {
+			uint32_t current = word->load(std::memory_order_acquire);
+			if ((current & kSharedNotifierCount) !=
+				(last & kSharedNotifierCount)) {
+				last = current & kSharedNotifierCount;
+				return true;
+			}
+			auto now = std::chrono::steady_clock::now();
+			if (now >= deadline) return false;
+#if defined(__linux__)
+			// the producer wakes the futex only if the bit is set
+			if (!(current & kSharedNotifierWaiters)) {
+				if (!word->compare_exchange_weak(current,
+					current | kSharedNotifierWaiters, std::memory_order_acquire,
+					std::memory_order_acquire)) {
+					continue;
+				}
+				current |= kSharedNotifierWaiters;
+			}
+			auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				deadline - now).count();
+			struct timespec ts;
+			ts.tv_sec = static_cast<time_t>(remaining / 1000000000);
+			ts.tv_nsec = static_cast<long>(remaining % 1000000000);
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT,
+				current, &ts, nullptr, 0);
+#else
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+		}
+	}
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDNOTIFIER_HPP__
@@ -0,0 +1,157 @@
+/**
+* @file SharedNuma.hpp
+* @brief NUMA placement of the shared memory and affinity of the threads.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDNUMA_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDNUMA_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+namespace co
+{
+namespace shm
+{
+
+// Object (or thread) without a NUMA node
+const int kSharedNumaNodeNone = -1;
+
+// Memory policy of mbind (linux/mempolicy.h)
+const int kSharedNumaPolicyBind = 2;
+// Move the pages already in memory (linux/mempolicy.h)
+const unsigned kSharedNumaMoveFlag = 2;
+
+/** @brief NUMA placement of a memory range and CPU affinity of the calling
+           thread.
+
+	It calls the kernel directly, so it does not depend on libnuma. On the
+	systems without NUMA support the functions return false.
+*/
+class SharedNuma
+{
+public:
+
+	/** @brief It returns true if the memory can be bound to a node
+	*/
+	static bool is_available() {
+#if defined(__linux__) && defined(SYS_mbind)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/** @brief It binds the pages that contain a memory range to a node.
+
+		The pages already in memory are moved. For a shared memory the
+		policy is shared by all the processes that map it.
+	*/
+	static bool bind(void *ptr, size_t bytes, int node) {
+		if (ptr == nullptr || bytes == 0 || node < 0) return false;
+#if defined(__linux__) && defined(SYS_mbind)
+		const size_t kBitsLong = 8 * sizeof(unsigned long);
+		if (static_cast<size_t>(node) >= 16 * kBitsLong) return false;
+		unsigned long mask[16] = { 0 };
+		mask[node / kBitsLong] = 1UL << (node % kBitsLong);
+		uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+		uintptr_t begin = reinterpret_cast<uintptr_t>(ptr) / page * page;
+		uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + bytes + page - 1) /
+			page * page;
+		return syscall(SYS_mbind, reinterpret_cast<void*>(begin), end - begin,
+			kSharedNumaPolicyBind, mask, 16 * kBitsLong + 1,
+			kSharedNumaMoveFlag) == 0;
+#else
+		return false;
+#endif
+	}
+
+	/** @brief It returns the CPUs of a node (from sysfs)
+	*/
+	static bool node_cpus(int node, std::vector<int> &cpus) {
+		cpus.clear();
+		if (node < 0) return false;
+		return read_cpulist("/sys/devices/system/node/node" +
+			std::to_string(node) + "/cpulist", cpus);
+	}
+
+	/** @brief It reads a list of CPUs in the format of sysfs (i.e. 0-7,16-23)
+	*/
+	static bool read_cpulist(const std::string &filename,
+		std::vector<int> &cpus) {
+		cpus.clear();
+		std::ifstream f(filename);
+		std::string list;
+		if (!f.is_open() || !std::getline(f, list)) return false;
+		std::stringstream ss(list);
+		std::string range;
+		while (std::getline(ss, range, ',')) {
+			if (range.empty()) continue;
+			size_t dash = range.find('-');
+			int first = std::stoi(range.substr(0, dash));
+			int last = dash == std::string::npos ? first :
+				std::stoi(range.substr(dash + 1));
+			for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+		}
+		return !cpus.empty();
+	}
+
+	/** @brief It restricts the calling thread to a set of CPUs
+	*/
+	static bool set_thread_affinity(const std::vector<int> &cpus) {
+		if (cpus.empty()) return false;
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		for (auto cpu : cpus) {
+			if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+		}
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#elif defined(_WIN32)
+		DWORD_PTR mask = 0;
+		for (auto cpu : cpus) {
+			if (cpu >= 0 && cpu < static_cast<int>(8 * sizeof(DWORD_PTR))) {
+				mask |= static_cast<DWORD_PTR>(1) << cpu;
+			}
+		}
+		return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+		return false;
+#endif
+	}
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDNUMA_HPP__
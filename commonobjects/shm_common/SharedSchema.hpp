@@ -0,0 +1,544 @@
+/**
+* @file SharedSchema.hpp
+* @brief Typed description of the objects of a shared memory, checked at
+*        compile time.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   CO_SHM_SCHEMA_NAME(RgbName, "rgb");
+*   CO_SHM_SCHEMA_NAME(CloudName, "cloud");
+*   typedef co::shm::SharedImageDesc<RgbName, 640, 480, 3> Rgb;
+*   typedef co::shm::SharedPclDesc<CloudName, 16, 300000> Cloud;
+*   typedef co::shm::SharedSchema<Rgb, Cloud> MySchema;
+*
+*   // producer
+*   shared_data.parse_schema<MySchema>("MyMemory", "SharedObject");
+*   // consumer (fails if the producer uses another layout)
+*   shared_data.detect_schema<MySchema>("MyMemory", "SharedObject");
+*   co::shm::SharedSchemaObject<MySchema, Rgb> rgb(shared_data);
+*   rgb.write(image.data);
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDSCHEMA_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDSCHEMA_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "SharedDataDerivedSample.hpp"
+
+/** @brief It declares the name of an object of a schema.
+*/
+#define CO_SHM_SCHEMA_NAME(id, str) \
+	struct id { static constexpr const char* name() { return str; } }
+
+namespace co
+{
+namespace shm
+{
+
+// Seed of the schema hash (FNV-1a offset basis)
+const uint64_t kSharedSchemaHashSeed = 14695981039346656037ULL;
+
+/** @brief FNV-1a hash of a string (compile time)
+*/
+constexpr uint64_t schema_hash_str(const char *s, uint64_t hash) {
+	return *s == 0 ? (hash ^ 0xff) * 1099511628211ULL :
+		schema_hash_str(s + 1, (hash ^ static_cast<unsigned char>(*s)) *
+		1099511628211ULL);
+}
+
+/** @brief FNV-1a hash of the 8 bytes of an integer (compile time)
+*/
+constexpr uint64_t schema_hash_int(uint64_t value, uint64_t hash,
+	int num_bytes = 8) {
+	return num_bytes == 0 ? hash :
+		schema_hash_int(value >> 8, (hash ^ (value & 0xff)) * 1099511628211ULL,
+		num_bytes - 1);
+}
+
+/** @brief It compares two strings (compile time)
+*/
+constexpr bool schema_str_equal(const char *a, const char *b) {
+	return *a == *b && (*a == 0 || schema_str_equal(a + 1, b + 1));
+}
+
+/** @brief Raw memory of an image: width * height * channels bytes, or the
+           triple buffer that contains it (one writer, any number of
+           readers, see SharedTripleBuffer).
+*/
+template<typename Name, int Width, int Height, int Channels,
+	bool Triple = false>
+struct SharedImageDesc
+{
+	typedef Name name_type;
+	typedef unsigned char value_type;
+
+	static constexpr const char* type() { return "image"; }
+	static constexpr size_t elements() {
+		return static_cast<size_t>(Width) * Height * Channels;
+	}
+	static constexpr size_t raw_bytes() {
+		return Triple ? SharedTripleBuffer::memory_size(elements()) :
+			elements();
+	}
+	static constexpr uint64_t hash(uint64_t h) {
+		return schema_hash_int(Triple, schema_hash_int(Channels,
+			schema_hash_int(Height, schema_hash_int(Width, schema_hash_str(
+			Name::name(), schema_hash_str(type(), h))))));
+	}
+	static std::string message() {
+		return std::string(type()) + "," + Name::name() + "," +
+			std::to_string(Width) + "," + std::to_string(Height) + "," +
+			std::to_string(Channels) + (Triple ? ",triple" : "");
+	}
+	/** @brief It sets the information of the object
+	*/
+	static void setup(SharedDataDerivedSample &shared, size_t id) {
+		shared.setup_image(id, Name::name(), Width, Height, Channels,
+			Triple ? kImageBufferTriple : kImageBufferSingle);
+	}
+
+	/** @brief It copies a whole image in the shared memory
+	*/
+	static bool write(SharedDataDerivedSample &shared, size_t id,
+		const value_type *data) {
+		return shared.image_copyFrom(id, data, elements());
+	}
+	/** @brief It copies the most recent image from the shared memory
+	*/
+	static bool read(SharedDataDerivedSample &shared, size_t id,
+		value_type *data) {
+		return shared.image_copyTo(id, data, elements());
+	}
+};
+
+/** @brief Raw memory of a point cloud: num_points points of bytes_point
+           bytes. int_vector_[1] holds the number of valid points.
+*/
+template<typename Name, int BytesPoint, int NumPoints>
+struct SharedPclDesc
+{
+	typedef Name name_type;
+	typedef unsigned char value_type;
+
+	static constexpr const char* type() { return "pcl"; }
+	static constexpr size_t raw_bytes() {
+		return static_cast<size_t>(BytesPoint) * NumPoints;
+	}
+	static constexpr uint64_t hash(uint64_t h) {
+		return schema_hash_int(NumPoints, schema_hash_int(BytesPoint,
+			schema_hash_str(Name::name(), schema_hash_str(type(), h))));
+	}
+	static std::string message() {
+		return std::string(type()) + "," + Name::name() + "," +
+			std::to_string(BytesPoint) + "," + std::to_string(NumPoints);
+	}
+	/** @brief It sets the information of the object
+	*/
+	static void setup(SharedDataDerivedSample &shared, size_t id) {
+		shared.setup_pcl(id, Name::name(), NumPoints);
+	}
+
+	/** @brief It copies num_points points, sets the valid points and
+	           notifies the object (under a write lease)
+	*/
+	static bool write(SharedDataDerivedSample &shared, size_t id,
+		const void *points, int num_points) {
+		if (num_points < 0 || num_points > NumPoints) return false;
+		size_t size = 0;
+		void *ptr = shared.object_acquire_write(id, size);
+		if (ptr == nullptr) return false;
+		size_t bytes = static_cast<size_t>(num_points) * BytesPoint;
+		if (bytes > size) {
+			shared.object_release_write(id, false);
+			return false;
+		}
+		memcpy(ptr, points, bytes);
+		shared.smm().object_Veci_modify(id, 1, num_points);
+		shared.object_release_write(id, true);
+		return true;
+	}
+	/** @brief It copies the valid points (under a read lease)
+
+		@param[in] points Memory of NumPoints points at least.
+		@param[out] num_points Number of valid points copied.
+	*/
+	static bool read(SharedDataDerivedSample &shared, size_t id,
+		void *points, int &num_points) {
+		size_t size = 0;
+		const void *ptr = shared.object_acquire_read(id, size);
+		if (ptr == nullptr) {
+			num_points = 0;
+			return false;
+		}
+		bool err = false;
+		num_points = shared.smm().object_Veci(id, 1, err);
+		if (err || num_points < 0 || num_points > NumPoints ||
+			static_cast<size_t>(num_points) * BytesPoint > size) {
+			shared.object_release_read(id, ptr);
+			num_points = 0;
+			return false;
+		}
+		memcpy(points, ptr, static_cast<size_t>(num_points) * BytesPoint);
+		shared.object_release_read(id, ptr);
+		return true;
+	}
+};
+
+/** @brief Raw memory of the skeletons: num_skeletons * num_points_skeleton
+           points of bytes_point bytes.
+*/
+template<typename Name, int BytesPoint, int NumSkeletons,
+	int NumPointsSkeleton>
+struct SharedPoseDesc
+{
+	typedef Name name_type;
+	typedef unsigned char value_type;
+
+	static constexpr const char* type() { return "pose_kSize"; }
+	static constexpr size_t raw_bytes() {
+		return static_cast<size_t>(BytesPoint) * NumSkeletons *
+			NumPointsSkeleton;
+	}
+	static constexpr uint64_t hash(uint64_t h) {
+		return schema_hash_int(NumPointsSkeleton, schema_hash_int(NumSkeletons,
+			schema_hash_int(BytesPoint, schema_hash_str(Name::name(),
+			schema_hash_str(type(), h)))));
+	}
+	static std::string message() {
+		return std::string(type()) + "," + Name::name() + "," +
+			std::to_string(BytesPoint) + "," + std::to_string(NumSkeletons) +
+			"," + std::to_string(NumPointsSkeleton);
+	}
+	/** @brief It sets the information of the object
+	*/
+	static void setup(SharedDataDerivedSample &shared, size_t id) {
+		shared.setup_pose(id, Name::name(), NumSkeletons, NumPointsSkeleton);
+	}
+};
+
+/** @brief Single producer/single consumer ring of frames
+*/
+template<typename Name, int SlotBytes, int NumSlots>
+struct SharedRingDesc
+{
+	typedef Name name_type;
+	typedef unsigned char value_type;
+
+	static constexpr const char* type() { return "ring"; }
+	static constexpr size_t raw_bytes() {
+		return SharedFrameRing::memory_size(SlotBytes, NumSlots);
+	}
+	static constexpr uint64_t hash(uint64_t h) {
+		return schema_hash_int(NumSlots, schema_hash_int(SlotBytes,
+			schema_hash_str(Name::name(), schema_hash_str(type(), h))));
+	}
+	static std::string message() {
+		return std::string(type()) + "," + Name::name() + "," +
+			std::to_string(SlotBytes) + "," + std::to_string(NumSlots);
+	}
+	/** @brief It sets the information of the object
+	*/
+	static void setup(SharedDataDerivedSample &shared, size_t id) {
+		shared.setup_ring(id, Name::name(), SlotBytes, NumSlots);
+	}
+
+	/** @brief It pushes a frame (it returns false if the ring is full)
+	*/
+	static bool write(SharedDataDerivedSample &shared, size_t id,
+		const void *data, size_t bytes) {
+		return shared.ring_push(id, data, bytes);
+	}
+	/** @brief It pops the oldest frame (it returns false if empty)
+
+		@param[in] data Memory of SlotBytes bytes at least.
+	*/
+	static bool read(SharedDataDerivedSample &shared, size_t id,
+		void *data, size_t &bytes) {
+		return shared.ring_pop(id, data, SlotBytes, bytes);
+	}
+};
+
+/** @brief Single producer/multiple consumers ring of frames
+*/
+template<typename Name, int SlotBytes, int NumSlots, int MaxReaders,
+	bool Block = false>
+struct SharedBroadcastDesc
+{
+	typedef Name name_type;
+	typedef unsigned char value_type;
+
+	static constexpr const char* type() { return "broadcast"; }
+	static constexpr size_t raw_bytes() {
+		return SharedBroadcastRing::memory_size(SlotBytes, NumSlots,
+			MaxReaders);
+	}
+	static constexpr uint64_t hash(uint64_t h) {
+		return schema_hash_int(Block, schema_hash_int(MaxReaders,
+			schema_hash_int(NumSlots, schema_hash_int(SlotBytes,
+			schema_hash_str(Name::name(), schema_hash_str(type(), h))))));
+	}
+	static std::string message() {
+		return std::string(type()) + "," + Name::name() + "," +
+			std::to_string(SlotBytes) + "," + std::to_string(NumSlots) + "," +
+			std::to_string(MaxReaders) + (Block ? ",block" : "");
+	}
+	/** @brief It sets the information of the object
+	*/
+	static void setup(SharedDataDerivedSample &shared, size_t id) {
+		shared.setup_broadcast(id, Name::name(), SlotBytes, NumSlots,
+			MaxReaders, Block ? kBroadcastBlock : kBroadcastOverwrite);
+	}
+
+	/** @brief It publishes a frame to all the readers
+	*/
+	static bool write(SharedDataDerivedSample &shared, size_t id,
+		const void *data, size_t bytes) {
+		return shared.broadcast_publish(id, data, bytes);
+	}
+	/** @brief It copies the next frame of a reader
+
+		@param[in] data Memory of SlotBytes bytes at least.
+	*/
+	static bool read(SharedDataDerivedSample &shared, size_t id, int reader,
+		void *data, size_t &bytes, uint64_t &lost) {
+		return shared.broadcast_read(id, reader, data, SlotBytes, bytes, lost);
+	}
+};
+
+/** @brief Pool of reference counted frames
+*/
+template<typename Name, int SlotBytes, int NumSlots, int QueueSize>
+struct SharedPoolDesc
+{
+	typedef Name name_type;
+	typedef unsigned char value_type;
+
+	static constexpr const char* type() { return "pool"; }
+	static constexpr size_t raw_bytes() {
+		return SharedFramePool::memory_size(SlotBytes, NumSlots, QueueSize);
+	}
+	static constexpr uint64_t hash(uint64_t h) {
+		return schema_hash_int(QueueSize, schema_hash_int(NumSlots,
+			schema_hash_int(SlotBytes, schema_hash_str(Name::name(),
+			schema_hash_str(type(), h)))));
+	}
+	static std::string message() {
+		return std::string(type()) + "," + Name::name() + "," +
+			std::to_string(SlotBytes) + "," + std::to_string(NumSlots) + "," +
+			std::to_string(QueueSize);
+	}
+	/** @brief It sets the information of the object
+	*/
+	static void setup(SharedDataDerivedSample &shared, size_t id) {
+		shared.setup_pool(id, Name::name(), SlotBytes, NumSlots, QueueSize);
+	}
+};
+
+/** @brief Index of the descriptor D in the list (compile time)
+*/
+template<typename D, typename... Descs>
+struct SharedSchemaIndex;
+
+template<typename D, typename... Descs>
+struct SharedSchemaIndex<D, D, Descs...>
+{
+	static constexpr size_t value() { return 0; }
+};
+
+template<typename D, typename Head, typename... Descs>
+struct SharedSchemaIndex<D, Head, Descs...>
+{
+	static constexpr size_t value() {
+		return 1 + SharedSchemaIndex<D, Descs...>::value();
+	}
+};
+
+/** @brief Operations on the list of descriptors (compile time)
+*/
+template<typename... Descs>
+struct SharedSchemaList
+{
+	static constexpr uint64_t hash(uint64_t h) { return h; }
+	static constexpr size_t raw_bytes() { return 0; }
+	template<typename D>
+	static constexpr bool name_unused() { return true; }
+	static constexpr bool unique_names() { return true; }
+};
+
+template<typename Head, typename... Descs>
+struct SharedSchemaList<Head, Descs...>
+{
+	static constexpr uint64_t hash(uint64_t h) {
+		return SharedSchemaList<Descs...>::hash(Head::hash(h));
+	}
+	static constexpr size_t raw_bytes() {
+		return Head::raw_bytes() + SharedSchemaList<Descs...>::raw_bytes();
+	}
+	template<typename D>
+	static constexpr bool name_unused() {
+		return !schema_str_equal(D::name_type::name(), Head::name_type::name()) &&
+			SharedSchemaList<Descs...>::template name_unused<D>();
+	}
+	static constexpr bool unique_names() {
+		return SharedSchemaList<Descs...>::template name_unused<Head>() &&
+			SharedSchemaList<Descs...>::unique_names();
+	}
+};
+
+/** @brief Layout of a shared memory as a list of object descriptors.
+
+	The object ids, the sizes of the raw memory and the hash of the layout
+	are computed at compile time. The hash is saved in the shared memory
+	by the producer and compared at detect by the consumers.
+*/
+template<typename... Descs>
+struct SharedSchema
+{
+	static_assert(sizeof...(Descs) > 0, "The schema has no objects");
+	static_assert(SharedSchemaList<Descs...>::unique_names(),
+		"Two objects of the schema have the same name");
+
+	/** @brief Number of objects
+	*/
+	static constexpr size_t size() { return sizeof...(Descs); }
+
+	/** @brief Id of the object described by D
+	*/
+	template<typename D>
+	static constexpr size_t id() {
+		return SharedSchemaIndex<D, Descs...>::value();
+	}
+
+	/** @brief Hash of the layout (types, names and parameters)
+	*/
+	static constexpr uint64_t hash() {
+		return SharedSchemaList<Descs...>::hash(kSharedSchemaHashSeed);
+	}
+
+	/** @brief Total raw memory of the objects (bytes)
+	*/
+	static constexpr size_t raw_bytes() {
+		return SharedSchemaList<Descs...>::raw_bytes();
+	}
+
+	/** @brief Raw memory of each object (bytes)
+	*/
+	static std::vector<size_t> raw_sizes() {
+		return std::vector<size_t>({ Descs::raw_bytes()... });
+	}
+
+	/** @brief Name of each object
+	*/
+	static std::vector<std::string> names() {
+		return std::vector<std::string>({ Descs::name_type::name()... });
+	}
+
+	/** @brief Type of each object
+	*/
+	static std::vector<std::string> types() {
+		return std::vector<std::string>({ Descs::type()... });
+	}
+
+	/** @brief It sets the information of each object
+	           (SharedDataDerivedSample::parse_schema)
+	*/
+	static void setup(SharedDataDerivedSample &shared) {
+		int dummy[] = { (Descs::setup(shared, id<Descs>()), 0)... };
+		(void)dummy;
+	}
+
+	/** @brief Equivalent message for SharedDataDerivedSample::parse (layout
+	           of a warm restart, a replay and a tap)
+	*/
+	static std::string message() {
+		std::vector<std::string> v({ Descs::message()... });
+		std::string msg;
+		for (size_t i = 0; i < v.size(); ++i) {
+			if (i > 0) msg += "|";
+			msg += v[i];
+		}
+		return msg;
+	}
+};
+
+/** @brief Typed access to an object of a schema.
+
+	The id is a compile time constant, so no lookup by name is done.
+*/
+template<typename Schema, typename D>
+class SharedSchemaObject
+{
+public:
+
+	explicit SharedSchemaObject(SharedDataDerivedSample &shared) :
+		shared_(shared) {}
+
+	/** @brief Id of the object
+	*/
+	static constexpr size_t id() {
+		return Schema::template id<D>();
+	}
+
+	/** @brief Size of the raw memory (bytes)
+	*/
+	static constexpr size_t raw_bytes() {
+		return D::raw_bytes();
+	}
+
+	/** @brief Raw memory of the object
+	*/
+	typename D::value_type* data() {
+		size_t size = 0;
+		return static_cast<typename D::value_type*>(
+			shared_.smm().object_get_ptr(id(), size));
+	}
+
+	/** @brief It writes the object (see the descriptor)
+	*/
+	template<typename... Args>
+	bool write(Args&&... args) {
+		return D::write(shared_, id(), std::forward<Args>(args)...);
+	}
+
+	/** @brief It reads the object (see the descriptor)
+	*/
+	template<typename... Args>
+	bool read(Args&&... args) {
+		return D::read(shared_, id(), std::forward<Args>(args)...);
+	}
+
+	/** @brief It notifies the processes waiting for the object
+	*/
+	void notify() {
+		shared_.notify_object(id());
+	}
+
+private:
+
+	SharedDataDerivedSample &shared_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDSCHEMA_HPP__
@@ -0,0 +1,141 @@
+/**
+* @file SharedSeqlock.hpp
+* @brief Sequence lock that can be placed in the shared memory.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDSEQLOCK_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDSEQLOCK_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace co
+{
+namespace shm
+{
+
+// Maximum number of attempts of a reader before to give up
+const int kSeqlockMaxRetries = 1000;
+
+/** @brief Sequence lock.
+
+	The counter is odd while a writer modifies the protected data.
+	Readers never block the writers: they read the counter, copy the data,
+	and retry if the counter changed in the meantime.
+	Concurrent writers are serialized by spinning on the odd counter.
+*/
+class SharedSeqlock
+{
+public:
+
+	SharedSeqlock() : seq_(0) {}
+
+	/** @brief Writer. It marks the beginning of a modification.
+	*/
+	void write_begin() {
+		uint32_t s = seq_.load(std::memory_order_relaxed);
+		for (;;) {
+			if ((s & 1) == 0 && seq_.compare_exchange_weak(s, s + 1,
+				std::memory_order_acquire, std::memory_order_relaxed)) {
+				break;
+			}
+			if (s & 1) {
+				std::this_thread::yield();
+				s = seq_.load(std::memory_order_relaxed);
+			}
+		}
+		std::atomic_thread_fence(std::memory_order_release);
+	}
+
+	/** @brief Writer. It marks the end of a modification.
+	*/
+	void write_end() {
+		seq_.fetch_add(1, std::memory_order_release);
+	}
+
+	/** @brief Reader. It returns the sequence to pass to read_retry.
+
+		It waits while a writer is active.
+	*/
+	uint32_t read_begin() const {
+		uint32_t s = seq_.load(std::memory_order_acquire);
+		while (s & 1) {
+			std::this_thread::yield();
+			s = seq_.load(std::memory_order_acquire);
+		}
+		return s;
+	}
+
+	/** @brief Reader. It returns true if the data read after read_begin
+	           may be inconsistent and must be read again.
+	*/
+	bool read_retry(uint32_t s) const {
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return seq_.load(std::memory_order_relaxed) != s;
+	}
+
+	/** @brief It ends the modification of a writer that died while holding
+	           the lock (i.e. warm restart of a producer that crashed).
+	*/
+	void recover() {
+		uint32_t s = seq_.load(std::memory_order_relaxed);
+		if (s & 1) seq_.compare_exchange_strong(s, s + 1,
+			std::memory_order_release, std::memory_order_relaxed);
+	}
+
+	/** @brief Current value of the counter (number of modifications * 2)
+	*/
+	uint32_t sequence() const {
+		return seq_.load(std::memory_order_acquire);
+	}
+
+private:
+
+	std::atomic<uint32_t> seq_;
+};
+
+/** @brief Scoped writer of a sequence lock
+*/
+class SharedSeqlockWriteGuard
+{
+public:
+
+	explicit SharedSeqlockWriteGuard(SharedSeqlock &lock) : lock_(lock) {
+		lock_.write_begin();
+	}
+
+	~SharedSeqlockWriteGuard() {
+		lock_.write_end();
+	}
+
+private:
+
+	SharedSeqlockWriteGuard(const SharedSeqlockWriteGuard&);
+	SharedSeqlockWriteGuard& operator=(const SharedSeqlockWriteGuard&);
+
+	SharedSeqlock &lock_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDSEQLOCK_HPP__
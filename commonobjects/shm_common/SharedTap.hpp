@@ -0,0 +1,282 @@
+/**
+* @file SharedTap.hpp
+* @brief Append-only file of the updates of the shared objects (tap), to
+*        record and replay a shared memory.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDTAP_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDTAP_HPP__
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+namespace co
+{
+namespace shm
+{
+
+// Magic number at the beginning of a tap file
+const uint32_t kSharedTapMagic = 0x50415443; // "CTAP"
+// Version of the tap file
+const uint32_t kSharedTapVersion = 1;
+// Maximum size of a string of a tap file (name, layout, object string)
+const uint64_t kSharedTapMaxString = 1 << 20;
+// Maximum number of int or double values of a record
+const uint64_t kSharedTapMaxValues = 1 << 20;
+
+/** @brief Update of an object saved in a tap file
+*/
+struct SharedTapRecord
+{
+	SharedTapRecord() : id(0), sequence(0), timestamp_ns(0) {}
+
+	/** @brief Object id
+	*/
+	uint64_t id;
+	/** @brief Sequence of the publication (see SharedObjectHeader)
+	*/
+	uint64_t sequence;
+	/** @brief Time of the publication in the producer (ns)
+	*/
+	uint64_t timestamp_ns;
+	/** @brief Int and double vectors of the object
+	*/
+	std::vector<int> int_values;
+	std::vector<double> double_values;
+	/** @brief String of the object
+	*/
+	std::string text;
+	/** @brief Raw memory of the object (the frame for a triple buffer)
+	*/
+	std::vector<char> payload;
+};
+
+/** @brief Writer of a tap file.
+
+	The file has a header with the description of the memory (the message
+	of parse), followed by the records in order of arrival. The records are
+	only appended, so the file of a recorder that stopped abruptly is read
+	up to its last complete record.
+*/
+class SharedTapWriter
+{
+public:
+
+	/** @brief It creates the file and writes the header
+	*/
+	bool open(const std::string &filename, const std::string &name_shm,
+		const std::string &name_object, const std::string &layout) {
+		f_.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+		if (!f_.is_open()) {
+			std::cout << "Unable to create: " << filename << std::endl;
+			return false;
+		}
+		write_value(kSharedTapMagic);
+		write_value(kSharedTapVersion);
+		write_string(name_shm);
+		write_string(name_object);
+		write_string(layout);
+		return f_.good();
+	}
+
+	/** @brief It appends a record
+	*/
+	bool write(const SharedTapRecord &record) {
+		write_value(record.id);
+		write_value(record.sequence);
+		write_value(record.timestamp_ns);
+		write_value(static_cast<uint64_t>(record.int_values.size()));
+		write_value(static_cast<uint64_t>(record.double_values.size()));
+		write_value(static_cast<uint64_t>(record.text.size()));
+		write_value(static_cast<uint64_t>(record.payload.size()));
+		write_data(record.int_values.data(),
+			record.int_values.size() * sizeof(int));
+		write_data(record.double_values.data(),
+			record.double_values.size() * sizeof(double));
+		write_data(record.text.data(), record.text.size());
+		write_data(record.payload.data(), record.payload.size());
+		return f_.good();
+	}
+
+	/** @brief It writes the buffered records to the file
+	*/
+	void flush() {
+		f_.flush();
+	}
+
+	void close() {
+		f_.close();
+	}
+
+private:
+
+	template <typename T>
+	void write_value(const T &value) {
+		f_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void write_data(const void *data, size_t bytes) {
+		if (bytes > 0) f_.write(static_cast<const char*>(data), bytes);
+	}
+
+	void write_string(const std::string &s) {
+		write_value(static_cast<uint64_t>(s.size()));
+		write_data(s.data(), s.size());
+	}
+
+	std::ofstream f_;
+};
+
+/** @brief Reader of a tap file (see SharedTapWriter)
+*/
+class SharedTapReader
+{
+public:
+
+	SharedTapReader() : file_bytes_(0) {}
+
+	/** @brief It opens the file and reads the header
+	*/
+	bool open(const std::string &filename) {
+		f_.open(filename.c_str(), std::ios::binary);
+		if (!f_.is_open()) {
+			std::cout << "Unable to open: " << filename << std::endl;
+			return false;
+		}
+		// the sizes read are bounded by the bytes left in the file
+		f_.seekg(0, std::ios::end);
+		file_bytes_ = static_cast<uint64_t>(f_.tellg());
+		f_.seekg(0, std::ios::beg);
+		uint32_t magic = 0, version = 0;
+		if (!read_value(magic) || !read_value(version) ||
+			magic != kSharedTapMagic || version != kSharedTapVersion) {
+			std::cout << "Not a tap file: " << filename << std::endl;
+			return false;
+		}
+		return read_string(name_shm_) && read_string(name_object_) &&
+			read_string(layout_);
+	}
+
+	/** @brief It reads the next record
+
+		@return It returns false at the end of the file (or of the last
+		        complete record), or if the sizes of the record are not
+		        valid (corrupted file).
+	*/
+	bool read(SharedTapRecord &record) {
+		uint64_t num_int = 0, num_double = 0, num_text = 0, num_payload = 0;
+		if (!read_value(record.id) || !read_value(record.sequence) ||
+			!read_value(record.timestamp_ns) || !read_value(num_int) ||
+			!read_value(num_double) || !read_value(num_text) ||
+			!read_value(num_payload)) {
+			return false;
+		}
+		if (num_int > kSharedTapMaxValues ||
+			num_double > kSharedTapMaxValues ||
+			num_text > kSharedTapMaxString) {
+			std::cout << "Invalid record of the object " << record.id <<
+				std::endl;
+			return false;
+		}
+		// the record does not fit in the rest of the file: truncated (or a
+		// corrupted payload size)
+		uint64_t left = bytes_left();
+		if (num_payload > left ||
+			num_int * sizeof(int) + num_double * sizeof(double) + num_text >
+			left - num_payload) {
+			return false;
+		}
+		record.int_values.resize(num_int);
+		record.double_values.resize(num_double);
+		record.text.resize(num_text);
+		record.payload.resize(num_payload);
+		return read_data(record.int_values.data(), num_int * sizeof(int)) &&
+			read_data(record.double_values.data(),
+				num_double * sizeof(double)) &&
+			read_data(&record.text[0], num_text) &&
+			read_data(record.payload.data(), num_payload);
+	}
+
+	/** @brief Name of the recorded memory
+	*/
+	const std::string& name_shm() const {
+		return name_shm_;
+	}
+
+	/** @brief Name of the recorded objects
+	*/
+	const std::string& name_object() const {
+		return name_object_;
+	}
+
+	/** @brief Message of parse that created the recorded memory
+	*/
+	const std::string& layout() const {
+		return layout_;
+	}
+
+private:
+
+	template <typename T>
+	bool read_value(T &value) {
+		return static_cast<bool>(
+			f_.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	bool read_data(void *data, size_t bytes) {
+		return bytes == 0 ||
+			static_cast<bool>(f_.read(static_cast<char*>(data), bytes));
+	}
+
+	bool read_string(std::string &s) {
+		uint64_t size = 0;
+		if (!read_value(size) || size > kSharedTapMaxString ||
+			size > bytes_left()) {
+			return false;
+		}
+		s.resize(size);
+		return read_data(&s[0], size);
+	}
+
+	/** @brief Bytes of the file after the current position
+	*/
+	uint64_t bytes_left() {
+		std::streamoff pos = f_.tellg();
+		if (pos < 0 || static_cast<uint64_t>(pos) > file_bytes_) return 0;
+		return file_bytes_ - static_cast<uint64_t>(pos);
+	}
+
+	std::ifstream f_;
+	/** @brief Size of the file (bytes)
+	*/
+	uint64_t file_bytes_;
+	std::string name_shm_;
+	std::string name_object_;
+	std::string layout_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDTAP_HPP__
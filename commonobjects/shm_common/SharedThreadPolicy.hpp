@@ -0,0 +1,176 @@
+/**
+* @file SharedThreadPolicy.hpp
+* @brief Scheduling policy of the threads that listen for the objects.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDTHREADPOLICY_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDTHREADPOLICY_HPP__
+
+#include <iostream>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include "SharedNuma.hpp"
+
+namespace co
+{
+namespace shm
+{
+
+// Scheduler of a thread
+const int kSharedSchedOther = 0;
+const int kSharedSchedBatch = 1;
+const int kSharedSchedIdle = 2;
+const int kSharedSchedFifo = 3;
+const int kSharedSchedRoundRobin = 4;
+
+// The nice level of the thread is not modified
+const int kSharedNiceUnchanged = 100;
+
+/** @brief How a thread is scheduled.
+
+	The default policy does not modify the thread. The real time schedulers
+	(kSharedSchedFifo, kSharedSchedRoundRobin) need CAP_SYS_NICE or a
+	RLIMIT_RTPRIO limit on Linux.
+	i.e.
+	  SharedThreadPolicy policy;
+	  policy.scheduler = kSharedSchedFifo;
+	  policy.priority = 80;
+	  policy.isolated = true;     // one isolated CPU (isolcpus) per thread
+	  shared_data.set_thread_policy(policy);
+*/
+struct SharedThreadPolicy
+{
+	SharedThreadPolicy() : scheduler(kSharedSchedOther), priority(0),
+		nice(kSharedNiceUnchanged), isolated(false) {}
+
+	/** @brief Scheduler (kSharedSched*)
+	*/
+	int scheduler;
+	/** @brief Real time priority (1-99, only kSharedSchedFifo and
+	           kSharedSchedRoundRobin)
+	*/
+	int priority;
+	/** @brief Nice level (-20 to 19, kSharedNiceUnchanged to keep it)
+	*/
+	int nice;
+	/** @brief CPUs where the thread runs (empty: any)
+	*/
+	std::vector<int> cpus;
+	/** @brief If true and cpus is empty, each thread is pinned to a
+	           different isolated CPU (kernel parameter isolcpus). The
+	           scheduler does not balance the isolated CPUs, so a thread must
+	           be pinned to one of them.
+	*/
+	bool isolated;
+
+	/** @brief It returns true if the policy does not modify the thread
+	*/
+	bool is_default() const {
+		return scheduler == kSharedSchedOther && nice == kSharedNiceUnchanged &&
+			cpus.empty() && !isolated;
+	}
+
+	/** @brief It applies the policy to the calling thread.
+
+		@return It returns false if a part of the policy could not be applied
+		        (the other parts are applied anyway).
+	*/
+	bool apply() const {
+		bool ok = true;
+#if defined(__linux__)
+		if (scheduler != kSharedSchedOther) {
+			sched_param param;
+			param.sched_priority = 0;
+			int policy = SCHED_OTHER;
+			switch (scheduler) {
+			case kSharedSchedBatch: policy = SCHED_BATCH; break;
+			case kSharedSchedIdle: policy = SCHED_IDLE; break;
+			case kSharedSchedFifo: policy = SCHED_FIFO; break;
+			case kSharedSchedRoundRobin: policy = SCHED_RR; break;
+			}
+			if (policy == SCHED_FIFO || policy == SCHED_RR) {
+				param.sched_priority = priority;
+			}
+			if (pthread_setschedparam(pthread_self(), policy, &param) != 0) {
+				std::cout << "Unable to set the scheduler " << scheduler <<
+					" (CAP_SYS_NICE or RLIMIT_RTPRIO required)" << std::endl;
+				ok = false;
+			}
+		}
+		if (nice != kSharedNiceUnchanged) {
+			// the nice level of a thread is the one of its task id
+			pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+			if (setpriority(PRIO_PROCESS, tid, nice) != 0) {
+				std::cout << "Unable to set the nice level " << nice <<
+					std::endl;
+				ok = false;
+			}
+		}
+#elif defined(_WIN32)
+		int win_priority = THREAD_PRIORITY_NORMAL;
+		if (scheduler == kSharedSchedFifo ||
+			scheduler == kSharedSchedRoundRobin) {
+			win_priority = THREAD_PRIORITY_TIME_CRITICAL;
+		} else if (scheduler == kSharedSchedIdle) {
+			win_priority = THREAD_PRIORITY_IDLE;
+		} else if (nice != kSharedNiceUnchanged) {
+			if (nice <= -10) win_priority = THREAD_PRIORITY_HIGHEST;
+			else if (nice < 0) win_priority = THREAD_PRIORITY_ABOVE_NORMAL;
+			else if (nice >= 10) win_priority = THREAD_PRIORITY_LOWEST;
+			else if (nice > 0) win_priority = THREAD_PRIORITY_BELOW_NORMAL;
+		}
+		if (scheduler == kSharedSchedBatch) {
+			SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+		} else if (win_priority != THREAD_PRIORITY_NORMAL) {
+			ok = SetThreadPriority(GetCurrentThread(), win_priority) != 0;
+		}
+#else
+		ok = scheduler == kSharedSchedOther && nice == kSharedNiceUnchanged;
+#endif
+		if (!cpus.empty() && !SharedNuma::set_thread_affinity(cpus)) {
+			std::cout << "Unable to set the affinity of the thread" << std::endl;
+			ok = false;
+		}
+		return ok;
+	}
+
+	/** @brief It returns the CPUs isolated from the scheduler (isolcpus)
+	*/
+	static bool isolated_cpus(std::vector<int> &cpus) {
+		return SharedNuma::read_cpulist("/sys/devices/system/cpu/isolated",
+			cpus);
+	}
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDTHREADPOLICY_HPP__
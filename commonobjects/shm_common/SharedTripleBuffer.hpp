@@ -0,0 +1,238 @@
+/**
+* @file SharedTripleBuffer.hpp
+* @brief Lock-free triple buffer to share the latest frame between processes.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#ifndef COMMONOBJECTS_SHMCOMMON_SHAREDTRIPLEBUFFER_HPP__
+#define COMMONOBJECTS_SHMCOMMON_SHAREDTRIPLEBUFFER_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "SharedFrameRing.hpp"
+
+namespace co
+{
+namespace shm
+{
+
+// Magic number written in an initialized triple buffer header
+const uint32_t kSharedTripleBufferMagic = 0x54524942; // "TRIB"
+
+// Index of the latest buffer before the first frame is written
+const uint32_t kSharedTripleBufferNone = 0x3;
+// Number of buffers
+const uint32_t kSharedTripleBufferCount = 3;
+
+/** @brief Header of the triple buffer. It lives at the beginning of the raw
+           memory of the shared object.
+
+	back is owned by the writer. latest is the last complete frame, and
+	readers counts the readers that pin each buffer. The writer never
+	writes latest or a pinned buffer.
+*/
+struct SharedTripleBufferHeader
+{
+	std::atomic<uint32_t> latest;
+	char pad_latest[kSharedCacheLineBytes - sizeof(std::atomic<uint32_t>)];
+	std::atomic<uint32_t> readers[kSharedTripleBufferCount];
+	char pad_readers[kSharedCacheLineBytes -
+		kSharedTripleBufferCount * sizeof(std::atomic<uint32_t>)];
+	uint32_t back;
+	char pad_back[kSharedCacheLineBytes - sizeof(uint32_t)];
+	uint32_t magic;
+	uint32_t reserved;
+	uint64_t buffer_bytes;
+	uint64_t buffer_stride;
+	char pad_info[kSharedCacheLineBytes - 3 * sizeof(uint64_t)];
+};
+
+/** @brief View over a triple buffer allocated in the shared memory.
+
+	The class does not own the memory. It supports one writer and any
+	number of readers. A reader pins the most recent complete frame
+	(acquire_read) until it releases it (release_read), and the writer
+	fills a buffer that is neither the latest frame nor pinned. Neither side
+	waits for the other: the writer has no free buffer (begin_write returns
+	nullptr) only while the readers pin the two frames before the latest.
+*/
+class SharedTripleBuffer
+{
+public:
+
+	SharedTripleBuffer() : header_(nullptr) {}
+
+	explicit SharedTripleBuffer(void *ptr) :
+		header_(static_cast<SharedTripleBufferHeader*>(ptr)) {}
+
+	/** @brief It returns the bytes necessary to allocate the triple buffer.
+	*/
+	static constexpr size_t memory_size(size_t buffer_bytes) {
+		return sizeof(SharedTripleBufferHeader) +
+			kSharedTripleBufferCount * buffer_stride(buffer_bytes);
+	}
+
+	/** @brief It returns the distance in bytes between two buffers.
+	*/
+	static constexpr size_t buffer_stride(size_t buffer_bytes) {
+		return (buffer_bytes + kSharedCacheLineBytes - 1) /
+			kSharedCacheLineBytes * kSharedCacheLineBytes;
+	}
+
+	/** @brief It initializes the buffer. It must be called only once by the
+	           process that allocates the memory.
+	*/
+	void initialize(size_t buffer_bytes) {
+		if (header_ == nullptr) return;
+		new (&header_->latest) std::atomic<uint32_t>(kSharedTripleBufferNone);
+		for (uint32_t i = 0; i < kSharedTripleBufferCount; ++i) {
+			new (&header_->readers[i]) std::atomic<uint32_t>(0);
+		}
+		header_->back = 0;
+		header_->buffer_bytes = buffer_bytes;
+		header_->buffer_stride = buffer_stride(buffer_bytes);
+		header_->magic = kSharedTripleBufferMagic;
+	}
+
+	/** @brief It returns true if the memory contains an initialized buffer.
+	*/
+	bool is_valid() const {
+		return header_ != nullptr && header_->magic == kSharedTripleBufferMagic;
+	}
+
+	/** @brief Size of a single frame (bytes)
+	*/
+	size_t buffer_bytes() const {
+		return is_valid() ? static_cast<size_t>(header_->buffer_bytes) : 0;
+	}
+
+	/** @brief Writer. It returns the back buffer to fill.
+
+		@return The buffer or nullptr if the readers pin all the buffers
+		        that are not the latest frame.
+	*/
+	void* begin_write() {
+		if (!is_valid()) return nullptr;
+		// only the writer changes latest
+		uint32_t latest = header_->latest.load();
+		for (uint32_t i = 0; i < kSharedTripleBufferCount; ++i) {
+			uint32_t index = (header_->back + i) % kSharedTripleBufferCount;
+			// a reader pins only the latest frame (see acquire_read)
+			if (index != latest && header_->readers[index].load() == 0) {
+				header_->back = index;
+				return buffer(index);
+			}
+		}
+		return nullptr;
+	}
+
+	/** @brief Writer. It publishes the buffer obtained with begin_write as
+	           the latest frame.
+	*/
+	void commit_write() {
+		if (!is_valid()) return;
+		header_->latest.store(header_->back);
+	}
+
+	/** @brief Writer. It returns the last frame published by the writer
+	           (nullptr if no frame has been published).
+
+		The readers may be reading the same memory, so it must not be
+		modified.
+	*/
+	const void* latest_written() const {
+		if (!is_valid()) return nullptr;
+		uint32_t latest = header_->latest.load(std::memory_order_acquire);
+		return latest == kSharedTripleBufferNone ? nullptr : buffer(latest);
+	}
+
+	/** @brief Writer. It copies a frame and publishes it.
+	*/
+	bool write(const void *data, size_t bytes) {
+		if (!is_valid() || bytes > header_->buffer_bytes) return false;
+		void *ptr = begin_write();
+		if (ptr == nullptr) return false;
+		memcpy(ptr, data, bytes);
+		commit_write();
+		return true;
+	}
+
+	/** @brief Reader. It pins the most recent complete frame.
+
+		The memory is not modified until release_read is called.
+		@return The frame or nullptr if no frame has been published.
+	*/
+	const void* acquire_read() {
+		if (!is_valid()) return nullptr;
+		for (;;) {
+			uint32_t latest = header_->latest.load();
+			if (latest == kSharedTripleBufferNone) return nullptr;
+			header_->readers[latest].fetch_add(1);
+			// the writer may have taken the buffer before the pin was seen
+			if (header_->latest.load() == latest) return buffer(latest);
+			header_->readers[latest].fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	/** @brief Reader. It releases a frame pinned by acquire_read.
+	*/
+	void release_read(const void *data) {
+		if (!is_valid() || data == nullptr) return;
+		size_t offset = static_cast<size_t>(static_cast<const char*>(data) -
+			buffer(0));
+		uint32_t index = static_cast<uint32_t>(offset / header_->buffer_stride);
+		if (index < kSharedTripleBufferCount) {
+			header_->readers[index].fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	/** @brief Reader. It copies the most recent complete frame.
+
+		@return It returns false if no frame has been published.
+	*/
+	bool read(void *data, size_t bytes) {
+		if (!is_valid() || bytes > header_->buffer_bytes) return false;
+		const void *ptr = acquire_read();
+		if (ptr == nullptr) return false;
+		memcpy(data, ptr, bytes);
+		release_read(ptr);
+		return true;
+	}
+
+private:
+
+	/** @brief It returns the memory of a buffer
+	*/
+	char* buffer(uint32_t index) const {
+		return reinterpret_cast<char*>(header_) +
+			sizeof(SharedTripleBufferHeader) + index * header_->buffer_stride;
+	}
+
+	/** @brief Header of the triple buffer in the shared memory
+	*/
+	SharedTripleBufferHeader *header_;
+};
+
+} // namespace shm
+} // namespace co
+
+#endif // COMMONOBJECTS_SHMCOMMON_SHAREDTRIPLEBUFFER_HPP__
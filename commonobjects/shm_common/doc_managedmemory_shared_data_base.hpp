@@ -32,6 +32,7 @@
 #define COMMONOBJECTS_SHM_COMMON_DOC_MANAGEDMEMORY_SHAREDDATA_BASE_HPP__
 
 #include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/managed_mapped_file.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 #include <boost/interprocess/sync/interprocess_condition.hpp>
 #include <boost/interprocess/sync/scoped_lock.hpp>
@@ -46,6 +47,24 @@
 #include <cstdio>
 #include <vector>
 #include <string>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#if defined(__has_include)
+#if __has_include(<span>) && __cplusplus > 201703L
+#include <span>
+#endif
+#endif
+
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "SharedSeqlock.hpp"
+#include "SharedNotifier.hpp"
+#include "SharedNuma.hpp"
 
 namespace co
 {
@@ -67,6 +86,154 @@ typedef boost::container::basic_string<char, std::char_traits<char>, char_alloca
 //
 // @link http://www.boost.org/doc/libs/1_48_0/doc/html/interprocess/quick_guide.html
 
+/** @brief View of a vector of an object, without copy.
+
+	It points directly to the shared memory. A writer may modify the vector
+	while the view is used: changed() returns true in that case and the
+	values read must be discarded.
+	i.e.
+	  auto v = smm.object_Veci_view(id);
+	  int sum = std::accumulate(v.begin(), v.end(), 0);
+	  if (v.changed()) { retry }
+*/
+template <typename T>
+class SharedVectorView
+{
+public:
+
+	SharedVectorView() : data_(nullptr), size_(0), lock_(nullptr), seq_(0) {}
+
+	SharedVectorView(const T *data, size_t size, const SharedSeqlock *lock) :
+		data_(data), size_(size), lock_(lock),
+		seq_(lock != nullptr ? lock->read_begin() : 0) {}
+
+	const T* data() const { return data_; }
+	size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	const T* begin() const { return data_; }
+	const T* end() const { return data_ + size_; }
+	const T& operator[](size_t i) const { return data_[i]; }
+
+	/** @brief It returns true if the vector has been modified after the
+	           view has been created.
+	*/
+	bool changed() const {
+		return lock_ == nullptr || lock_->read_retry(seq_);
+	}
+
+#if defined(__cpp_lib_span)
+	std::span<const T> span() const {
+		return std::span<const T>(data_, size_);
+	}
+#endif
+
+private:
+
+	const T *data_;
+	size_t size_;
+	const SharedSeqlock *lock_;
+	uint32_t seq_;
+};
+
+/** @brief Modification of an object in a transaction (object_update).
+
+	A null pointer leaves the field unchanged.
+*/
+struct SharedObjectUpdate
+{
+	SharedObjectUpdate() : id(0), int_values(nullptr), int_count(0),
+		double_values(nullptr), double_count(0), msg(nullptr) {}
+
+	size_t id;
+	const int *int_values;
+	size_t int_count;
+	const double *double_values;
+	size_t double_count;
+	const char *msg;
+};
+
+/** @brief Statistics of an object.
+
+	The counters are updated atomically by the writers and by the threads
+	that deliver the callbacks, so a monitor process can read them at any
+	time (see shm_common_shm_stat).
+*/
+struct SharedObjectStats
+{
+	SharedObjectStats() : write_count(0), last_write_ns(0), bytes_written(0),
+		callbacks(0), missed(0), max_callback_ns(0) {}
+
+	/** @brief Time (ns) of a monotonic clock common to all the processes
+	           (steady_clock, CLOCK_MONOTONIC on Linux)
+	*/
+	static uint64_t now_ns() {
+		return static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	/** @brief It records a write of the object
+	*/
+	void record_write(size_t bytes, uint64_t time_ns = now_ns()) {
+		bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+		last_write_ns.store(time_ns, std::memory_order_relaxed);
+		write_count.fetch_add(1, std::memory_order_release);
+	}
+
+	/** @brief It records a callback and the writes it did not see
+	*/
+	void record_callback(uint64_t duration_ns, uint64_t missed_writes) {
+		callbacks.fetch_add(1, std::memory_order_relaxed);
+		if (missed_writes > 0) {
+			missed.fetch_add(missed_writes, std::memory_order_relaxed);
+		}
+		uint64_t current = max_callback_ns.load(std::memory_order_relaxed);
+		while (duration_ns > current &&
+			!max_callback_ns.compare_exchange_weak(current, duration_ns,
+			std::memory_order_relaxed)) {}
+	}
+
+	/** @brief Number of writes
+	*/
+	std::atomic<uint64_t> write_count;
+	/** @brief Time of the last write (ns, see now_ns)
+	*/
+	std::atomic<uint64_t> last_write_ns;
+	/** @brief Total bytes written
+	*/
+	std::atomic<uint64_t> bytes_written;
+	/** @brief Callbacks delivered (all the processes)
+	*/
+	std::atomic<uint64_t> callbacks;
+	/** @brief Writes overwritten before a callback could see them
+	*/
+	std::atomic<uint64_t> missed;
+	/** @brief Longest callback (ns)
+	*/
+	std::atomic<uint64_t> max_callback_ns;
+};
+
+/** @brief Header of the last publication of an object.
+
+	The producer writes it together with the payload, so a consumer can
+	detect the dropped publications (gaps of sequence) and measure the
+	latency (SharedObjectStats::now_ns() - timestamp_ns).
+*/
+struct SharedObjectHeader
+{
+	SharedObjectHeader() : sequence(0), timestamp_ns(0), length(0) {}
+
+	/** @brief Number of the publication (the first one is 1)
+	*/
+	uint64_t sequence;
+	/** @brief Time of the publication (ns, see SharedObjectStats::now_ns)
+	*/
+	uint64_t timestamp_ns;
+	/** @brief Bytes of the published payload
+	*/
+	uint64_t length;
+};
+
 /** @brief Shared Object set in the shared memory between process.
 */
 class SharedObject
@@ -80,7 +247,9 @@ public:
 	SharedObject(const allocator_type &void_alloc) : //ptr_(nullptr),
 		object_type_(void_alloc), object_name_(void_alloc),
 		char_string_(void_alloc),
-		int_vector_(void_alloc), double_vector_(void_alloc) {
+		int_vector_(void_alloc), double_vector_(void_alloc), notify_seq_(0),
+		lease_state_(0), numa_node_(kSharedNumaNodeNone), ptr_size_(0),
+		ptr_alignment_(1) {
 		std::cout << "SharedObject()" << std::endl;
 	}
 
@@ -88,9 +257,11 @@ public:
 		std::cout << "~SharedObject()" << std::endl;
 	}
 
-	void set_ptr(boost::interprocess::offset_ptr<void> &ptr, size_t ptr_size) {
+	void set_ptr(boost::interprocess::offset_ptr<void> &ptr, size_t ptr_size,
+		size_t ptr_alignment = 1) {
 		ptr_ = ptr;
 		ptr_size_ = ptr_size;
+		ptr_alignment_ = ptr_alignment;
 	}
 
 	/** @brief Access to the pointer to the allocated shared memory
@@ -105,6 +276,57 @@ public:
 		return ptr_size_;
 	}
 
+	/** @brief It returns the alignment (bytes) of the allocated memory
+	*/
+	size_t ptr_alignment() const {
+		return ptr_alignment_;
+	}
+
+	/** @brief It stamps the header and records the statistics of a
+	           publication.
+
+		The producer calls it before the payload is made visible (release of
+		a write lease) and before the notification.
+	*/
+	void publish(size_t length) {
+		publish(length, []() {});
+	}
+
+	/** @brief It makes the payload visible (i.e. commit of a triple buffer)
+	           and stamps the header in the same write section.
+
+		A reader that takes the header and the latest frame in one read
+		section of header_lock_ gets the frame of that publication, and the
+		frame is not written again before the sequence changes.
+	*/
+	template <typename Commit>
+	void publish(size_t length, Commit commit) {
+		uint64_t time_ns = SharedObjectStats::now_ns();
+		{
+			SharedSeqlockWriteGuard guard(header_lock_);
+			commit();
+			++header_.sequence;
+			header_.timestamp_ns = time_ns;
+			header_.length = length;
+		}
+		stats_.record_write(length, time_ns);
+	}
+
+	/** @brief It takes a consistent copy of the header of the last
+	           publication.
+
+		@return It returns false if a consistent copy was not possible.
+	*/
+	bool header(SharedObjectHeader &header,
+		int max_retries = kSeqlockMaxRetries) const {
+		for (int retry = 0; retry < max_retries; ++retry) {
+			uint32_t s = header_lock_.read_begin();
+			header = header_;
+			if (!header_lock_.read_retry(s)) return true;
+		}
+		return false;
+	}
+
 	/** @brief Container with the description of the object type
 	*/
 	char_string object_type_;
@@ -120,6 +342,34 @@ public:
 	/** @brief Array double data
 	*/
 	double_vector double_vector_;
+	/** @brief Sequence lock of int_vector_ and double_vector_.
+
+		Every writer of the vectors holds it, so readers can take a lock-free
+		consistent snapshot (see SharedMemoryManager::read_consistent).
+	*/
+	SharedSeqlock meta_lock_;
+	/** @brief Counter incremented at each notification of the object.
+
+		It is the word waited by the futex notification backend.
+	*/
+	std::atomic<uint32_t> notify_seq_;
+	/** @brief Leases of the raw memory: number of readers, the bit
+	           kSharedLeaseWriter while a writer holds it and the bit
+	           kSharedLeaseResize while object_reallocate replaces it.
+	*/
+	std::atomic<uint32_t> lease_state_;
+	/** @brief Statistics of the object
+	*/
+	SharedObjectStats stats_;
+	/** @brief Sequence lock of header_
+	*/
+	SharedSeqlock header_lock_;
+	/** @brief Header of the last publication (see publish)
+	*/
+	SharedObjectHeader header_;
+	/** @brief NUMA node of the raw memory (kSharedNumaNodeNone if not bound)
+	*/
+	int numa_node_;
 
 private:
 
@@ -129,6 +379,86 @@ private:
 	/** @brief Allocated raw pointer memory size (in bytes)
 	*/
 	size_t ptr_size_;
+	/** @brief Alignment of the raw pointer memory (bytes)
+	*/
+	size_t ptr_alignment_;
+};
+
+// Bit of SharedObject::lease_state_ set while a writer holds the memory
+const uint32_t kSharedLeaseWriter = 0x80000000;
+// Bit of SharedObject::lease_state_ set while the memory is reallocated
+const uint32_t kSharedLeaseResize = 0x40000000;
+
+// Empty entry of the object index
+const uint64_t kSharedObjectIndexEmpty = static_cast<uint64_t>(-1);
+
+/** @brief Entry of the hash table that maps an object name to its id.
+*/
+struct SharedObjectIndexEntry
+{
+	SharedObjectIndexEntry() : hash(0), id(kSharedObjectIndexEmpty) {}
+
+	/** @brief Hash of the object name
+	*/
+	uint64_t hash;
+	/** @brief Object id
+	*/
+	uint64_t id;
+};
+
+// Default alignment of the raw memory of an object (cache line, AVX-512)
+const size_t kSharedDefaultAlignment = 64;
+// Alignment of the raw memory of an object to a page
+const size_t kSharedPageAlignment = 4096;
+
+// Size of a huge page (bytes). The segment size is rounded to it.
+const size_t kSharedHugePageBytes = 2 * 1024 * 1024;
+
+/** @brief Options to map the shared memory segment
+*/
+struct SharedMemoryOptions
+{
+	SharedMemoryOptions() : huge_pages(false), prefault(false),
+		lock_memory(false), alignment(kSharedDefaultAlignment),
+		numa_node(kSharedNumaNodeNone), persistent(false),
+		reserve_bytes(0) {}
+
+	/** @brief Ask the kernel to back the segment with huge pages
+	           (transparent huge pages, shmem_enabled must be "advise" or
+	           "always").
+	*/
+	bool huge_pages;
+	/** @brief Fault all the pages of the segment when mapped
+	*/
+	bool prefault;
+	/** @brief Lock the segment in RAM (mlock). It may require to raise
+	           RLIMIT_MEMLOCK.
+	*/
+	bool lock_memory;
+	/** @brief Alignment of the raw memory of the objects (bytes, power of 2).
+	           Use kSharedPageAlignment for page aligned buffers.
+	*/
+	size_t alignment;
+	/** @brief NUMA node of the raw memory of all the objects
+	           (kSharedNumaNodeNone to keep the first touch placement). Each
+	           object can be moved with object_bind_node.
+	*/
+	int numa_node;
+	/** @brief File of the segment (i.e. on tmpfs or on a NVMe disk). If it
+	           is empty the segment is a shared memory, otherwise it is a
+	           memory mapped file. All the processes must use the same file.
+	*/
+	std::string file;
+	/** @brief The segment is not removed when the creator exits. A
+	           producer that starts again reattaches to the segment and its
+	           content (warm restart) if the layout did not change.
+	*/
+	bool persistent;
+	/** @brief Free memory added to the segment for the objects that are
+	           reallocated later (object_reallocate, image_resize): a mapped
+	           segment does not grow.
+	*/
+	size_t reserve_bytes;
 };
 
 typedef void_allocator::rebind<SharedObject>::other    SharedObject_allocator;
@@ -144,13 +474,15 @@ public:
 	/** @brief 'ctor
 	*/
 	SharedMemoryManager() : do_destroy_(false), shared_object_(nullptr),
-		do_deallocate_(false), num_items_(0) {}
+		do_deallocate_(false), num_items_(0), index_(nullptr),
+		index_size_(0), update_lock_(nullptr) {}
 
 	~SharedMemoryManager() {
 		std::cout << "~SharedMemoryManager" << std::endl;
+		if (options_.persistent) return;
 		if (do_deallocate_) deallocate();
 		if (do_destroy_) {
-			if (!boost::interprocess::shared_memory_object::remove(shared_memory_name_.c_str())) {
+			if (!remove_segment()) {
 				std::cout << "Unable to remove the shared memory" << std::endl;
 			}
 		}
@@ -160,31 +492,60 @@ public:
 
 	@param[in] shared_memory_name The name associated to the shared memory.
 	@param[in] memory_to_instantiate_size The full instantiated memory.
+	@param[in] options How to map the memory.
 	*/
 	bool create(
 		const std::string &shared_memory_name, 
-		size_t memory_to_instantiate_size) {
+		size_t memory_to_instantiate_size,
+		const SharedMemoryOptions &options = SharedMemoryOptions()) {
+
+		if (!check_options(options)) return false;
+		memory_to_instantiate_size += options.reserve_bytes;
+		if (options.huge_pages) {
+			memory_to_instantiate_size = (memory_to_instantiate_size +
+				kSharedHugePageBytes - 1) / kSharedHugePageBytes *
+				kSharedHugePageBytes;
+		}
 
 		shared_memory_name_ = shared_memory_name;
 
 		do_destroy_ = true;
+		index_ = nullptr;
+		index_size_ = 0;
+
+		options_ = options;
 
 		std::cout << "shm_remove" << std::endl;
-		if (boost::interprocess::shared_memory_object::remove(shared_memory_name_.c_str())) {
+		if (remove_segment()) {
 			std::cout << "Successfully removed the shared memory: " <<
 				shared_memory_name_ << std::endl;
 		}
 
 		do_deallocate_ = true;
 
-		//Create a managed shared memory
-		boost::interprocess::managed_shared_memory managed_shm_tmp(boost::interprocess::create_only,
-			shared_memory_name_.c_str(), memory_to_instantiate_size);
+		if (!options_.file.empty()) {
+			//Create a managed memory mapped file
+			boost::interprocess::managed_mapped_file managed_file_tmp(
+				boost::interprocess::create_only, options_.file.c_str(),
+				memory_to_instantiate_size);
+			assert(managed_file_tmp.get_size() == memory_to_instantiate_size);
+			std::swap(managed_file_tmp, managed_file_);
+		} else {
+			//Create a managed shared memory
+			boost::interprocess::managed_shared_memory managed_shm_tmp(boost::interprocess::create_only,
+				shared_memory_name_.c_str(), memory_to_instantiate_size);
 
-		//Check size
-		assert(managed_shm_tmp.get_size() == memory_to_instantiate_size);
+			//Check size
+			assert(managed_shm_tmp.get_size() == memory_to_instantiate_size);
 
-		std::swap(managed_shm_tmp, managed_shm_);
+			std::swap(managed_shm_tmp, managed_shm_);
+		}
+		if (options_.alignment < kSharedDefaultAlignment) {
+			options_.alignment = kSharedDefaultAlignment;
+		}
+		apply_options(options, true);
+		update_lock_ = segment()->find_or_construct<SharedSeqlock>(
+			"update_lock")();
 		return true;
 	}
 
@@ -192,11 +553,14 @@ public:
 
 		@param[in] shared_memory_name Name of the shared memory
 		@param[in] shared_object_name Name of the shared object/s ("SharedObject")
+		@param[in] options How to map the memory.
 	*/
 	bool detect(
 		const std::string &shared_memory_name,
-		const std::string &shared_object_name) {
+		const std::string &shared_object_name,
+		const SharedMemoryOptions &options = SharedMemoryOptions()) {
 
+		if (!check_options(options)) return false;
 		try
 		{
 
@@ -209,14 +573,22 @@ public:
 			std::cout << "Try to detect shared object: " <<
 				shared_object_name_ << std::endl;
 
-			boost::interprocess::managed_shared_memory managed_shm_tmp(
-				boost::interprocess::open_only,
-				shared_memory_name_.c_str());
+			options_ = options;
+			if (!options_.file.empty()) {
+				boost::interprocess::managed_mapped_file managed_file_tmp(
+					boost::interprocess::open_only, options_.file.c_str());
+				std::swap(managed_file_tmp, managed_file_);
+			} else {
+				boost::interprocess::managed_shared_memory managed_shm_tmp(
+					boost::interprocess::open_only,
+					shared_memory_name_.c_str());
 
-			std::cout << "Swap previous managed shared memory" << std::endl;
-			std::swap(managed_shm_tmp, managed_shm_);
+				std::cout << "Swap previous managed shared memory" << std::endl;
+				std::swap(managed_shm_tmp, managed_shm_);
+			}
+			apply_options(options, false);
 
-			auto tmp = managed_shm_.find<SharedObject>(shared_object_name_.c_str());
+			auto tmp = segment()->find<SharedObject>(shared_object_name_.c_str());
 			if (tmp.first == nullptr) return false;
 			shared_object_ = tmp.first;
 			num_items_ = tmp.second;
@@ -224,11 +596,14 @@ public:
 			do_deallocate_ = false;
 			do_destroy_ = false;
 
-			// get the object name to define the key id
-			for (size_t i = 0; i < num_items_; ++i) {
-				key_id_[std::string(shared_object_[i].object_name_.begin(),
-					shared_object_[i].object_name_.end())] = i;
-			}
+			// get the index of the object names (built by the creator)
+			auto index = segment()->find<SharedObjectIndexEntry>(
+				(shared_object_name_ + "_index").c_str());
+			index_ = index.first;
+			index_size_ = index.second;
+
+			update_lock_ = segment()->find_or_construct<SharedSeqlock>(
+				"update_lock")();
 
 			return true;
 
@@ -257,21 +632,33 @@ public:
 			shared_object_name_ << std::endl;
 
 		//An allocator convertible to any allocator<T, segment_manager_t> type
-		void_allocator alloc_inst(managed_shm_.get_segment_manager());
+		void_allocator alloc_inst(segment());
 
 		// Construct an array of named objects
 		// The total number of objects is instantiated and fix
-		shared_object_ = managed_shm_.find_or_construct<SharedObject>(
+		shared_object_ = segment()->find_or_construct<SharedObject>(
 			shared_object_name_.c_str())[index_size.size()](alloc_inst);
 
 		// It allocates the pointer memory (raw memory) for each object.
 		for (size_t i = 0; i < index_size.size(); ++i)
 		{
 			// Allocate n bytes
-			boost::interprocess::offset_ptr<void> o_ptr = managed_shm_.allocate(
-				index_size[i], std::nothrow);
+			// The size is rounded to the alignment, so that two objects never
+			// share a cache line.
+			size_t alignment = options_.alignment;
+			size_t bytes = (index_size[i] + alignment - 1) / alignment * alignment;
+			boost::interprocess::offset_ptr<void> o_ptr = 
+				segment()->allocate_aligned(bytes, alignment, std::nothrow);
 			if (o_ptr == nullptr) return false;
-			shared_object_[i].set_ptr(o_ptr, index_size[i]);
+			shared_object_[i].set_ptr(o_ptr, index_size[i], alignment);
+			if (options_.numa_node != kSharedNumaNodeNone) {
+				if (SharedNuma::bind(o_ptr.get(), bytes, options_.numa_node)) {
+					shared_object_[i].numa_node_ = options_.numa_node;
+				} else {
+					std::cout << "Unable to bind the object " << i <<
+						" to the node " << options_.numa_node << std::endl;
+				}
+			}
 		}
 
 		// Total number of objects
@@ -280,19 +667,267 @@ public:
 		return true;
 	}
 
+	/** @brief It builds the hash table of the object names.
+
+		It must be called after all the names are set. The table is saved in
+		the shared memory, so detect uses it without building it again.
+	*/
+	bool build_index() {
+		size_t size = 1;
+		while (size < num_items_ * 2) size <<= 1;
+		std::string name = shared_object_name_ + "_index";
+		segment()->destroy<SharedObjectIndexEntry>(name.c_str());
+		index_ = segment()->construct<SharedObjectIndexEntry>(
+			name.c_str(), std::nothrow)[size]();
+		if (index_ == nullptr) {
+			index_size_ = 0;
+			return false;
+		}
+		index_size_ = size;
+		for (size_t i = 0; i < num_items_; ++i) {
+			const char_string &obj_name = shared_object_[i].object_name_;
+			uint64_t hash = hash_name(obj_name.data(), obj_name.size());
+			size_t pos = static_cast<size_t>(hash) & (index_size_ - 1);
+			while (index_[pos].id != kSharedObjectIndexEmpty) {
+				pos = (pos + 1) & (index_size_ - 1);
+			}
+			index_[pos].hash = hash;
+			index_[pos].id = i;
+		}
+		return true;
+	}
+
+	/** @brief FNV-1a hash of an object name (or of a message)
+	*/
+	static uint64_t hash_name(const char *name, size_t size) {
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < size; ++i) {
+			hash ^= static_cast<unsigned char>(name[i]);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	/** @brief It returns the id of the object with a given name.
+
+		It uses the hash table of the names if it exists.
+		@return The object id or kSharedObjectIndexEmpty if it does not exist.
+	*/
+	size_t key_id(const std::string &key) const {
+		if (index_ != nullptr && index_size_ > 0) {
+			uint64_t hash = hash_name(key.data(), key.size());
+			size_t pos = static_cast<size_t>(hash) & (index_size_ - 1);
+			for (size_t n = 0; n < index_size_; ++n) {
+				const SharedObjectIndexEntry &e = index_[pos];
+				if (e.id == kSharedObjectIndexEmpty) break;
+				if (e.hash == hash && e.id < num_items_ && 
+					is_object_name(e.id, key)) {
+					return static_cast<size_t>(e.id);
+				}
+				pos = (pos + 1) & (index_size_ - 1);
+			}
+			return kSharedObjectIndexEmpty;
+		}
+		// no index available
+		for (size_t i = 0; i < num_items_; ++i) {
+			if (is_object_name(i, key)) return i;
+		}
+		return kSharedObjectIndexEmpty;
+	}
+
+	/** @brief It grows a segment that no process maps.
+
+		Boost.Interprocess grows a segment only offline: a process that
+		maps it while it grows keeps the old size, and its allocator may
+		hand out (or walk) the new memory beyond its mapping. So a mapped
+		segment never grows: create it large enough (see
+		SharedMemoryOptions::reserve_bytes), or grow it between two runs of a persistent
+		segment, before the producer attaches again.
+		@param[in] shared_memory_name Name of the shared memory (unused if
+		           options.file is set).
+		@param[in] extra_bytes Bytes added to the segment.
+		@param[in] options Mapping of the segment (file, huge_pages).
+		@return It returns true if the segment grew.
+	*/
+	static bool grow(const std::string &shared_memory_name,
+		size_t extra_bytes,
+		const SharedMemoryOptions &options = SharedMemoryOptions()) {
+		if (options.huge_pages) {
+			extra_bytes = (extra_bytes + kSharedHugePageBytes - 1) /
+				kSharedHugePageBytes * kSharedHugePageBytes;
+		}
+		bool grown = false;
+		try {
+			grown = options.file.empty() ?
+				boost::interprocess::managed_shared_memory::grow(
+				shared_memory_name.c_str(), extra_bytes) :
+				boost::interprocess::managed_mapped_file::grow(
+				options.file.c_str(), extra_bytes);
+		}
+		catch (std::exception &ex) {
+			std::cout << ex.what() << std::endl;
+		}
+		if (!grown) {
+			std::cout << "Unable to grow: " << shared_memory_name << std::endl;
+		}
+		return grown;
+	}
+
+	/** @brief It releases the locks and the write leases left by a producer
+	           that died, before it attaches again to a persistent segment
+	           (warm restart).
+
+		The read leases are kept: the consumers are still running.
+	*/
+	void recover() {
+		if (update_lock_ != nullptr) update_lock_->recover();
+		for (size_t i = 0; i < num_items_; ++i) {
+			SharedObject &obj = shared_object_[i];
+			obj.meta_lock_.recover();
+			obj.header_lock_.recover();
+			obj.lease_state_.fetch_and(~(kSharedLeaseWriter | kSharedLeaseResize),
+				std::memory_order_release);
+		}
+	}
+
+	/** @brief It writes the segment to disk.
+
+		Without a filename a file backed segment (SharedMemoryOptions::file)
+		is flushed with msync: the file is the checkpoint. With a filename
+		the segment is copied in a new file and flushed, which can be opened
+		later with SharedMemoryOptions::file (i.e. to inspect the memory of
+		a crashed process, or to start a producer from a snapshot).
+		The writers are not stopped, so an object written during the copy
+		may be inconsistent (its header sequence tells which publication it
+		contains).
+	*/
+	bool checkpoint(const std::string &filename = std::string()) {
+		char *address = segment_address();
+		size_t size = segment_size();
+		if (address == nullptr || size == 0) return false;
+		if (filename.empty()) {
+			if (options_.file.empty()) {
+				std::cout << "Checkpoint of a shared memory requires a file" <<
+					std::endl;
+				return false;
+			}
+#if defined(__unix__)
+			size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			char *begin = reinterpret_cast<char*>(
+				reinterpret_cast<uintptr_t>(address) / page * page);
+			return msync(begin, size + (address - begin), MS_SYNC) == 0;
+#else
+			return managed_file_.flush();
+#endif
+		}
+		try {
+			{
+				std::ofstream f(filename.c_str(),
+					std::ios::binary | std::ios::trunc);
+				if (!f.is_open()) {
+					std::cout << "Unable to create: " << filename << std::endl;
+					return false;
+				}
+				f.seekp(size - 1);
+				f.put(0);
+			}
+			boost::interprocess::file_mapping file(filename.c_str(),
+				boost::interprocess::read_write);
+			boost::interprocess::mapped_region region(file,
+				boost::interprocess::read_write, 0, size);
+			memcpy(region.get_address(), address, size);
+			return region.flush(0, size, false);
+		}
+		catch (std::exception &ex) {
+			std::cout << ex.what() << std::endl;
+			return false;
+		}
+	}
+
+	/** @brief It places the raw memory of an object on a NUMA node.
+
+		The pages are shared with the nearby objects if the alignment is
+		smaller than a page (see kSharedPageAlignment).
+	*/
+	bool object_bind_node(size_t id, int node) {
+		if (id >= num_items_) return false;
+		SharedObject &obj = shared_object_[id];
+		if (!SharedNuma::bind(obj.ptr(), obj.ptr_size(), node)) {
+			std::cout << "Unable to bind the object " << id << " to the node " <<
+				node << std::endl;
+			return false;
+		}
+		obj.numa_node_ = node;
+		return true;
+	}
+
+	/** @brief It allocates a new raw memory of an object.
+
+		The content is preserved up to the smaller size. It fails if the
+		segment has not enough free memory (a mapped segment does not grow,
+		see grow), or while the memory is leased (see
+		SharedObject::lease_state_): the old memory is freed only when no
+		reader or writer holds a lease. The copies
+		(object_ptr_copyTo/From, image_copyTo/From) take a lease, a pointer
+		returned by object_get_ptr is not protected.
+		@param[in] bytes New size of the raw memory.
+	*/
+	bool object_reallocate(size_t id, size_t bytes) {
+		return object_reallocate(id, bytes, [](void*) {});
+	}
+
+	/** @brief It allocates a new raw memory of an object, and initializes
+	           it before the leases can be taken again.
+
+		@param[in] init Function called with the new memory (i.e. to write
+		           the header of a triple buffer).
+	*/
+	template <typename Init>
+	bool object_reallocate(size_t id, size_t bytes, Init init) {
+		if (id >= num_items_) return false;
+		uint32_t expected = 0;
+		if (!shared_object_[id].lease_state_.compare_exchange_strong(expected,
+			kSharedLeaseResize, std::memory_order_acquire)) {
+			return false;
+		}
+		size_t alignment = options_.alignment;
+		size_t rounded = (bytes + alignment - 1) / alignment * alignment;
+		boost::interprocess::offset_ptr<void> o_ptr =
+			segment()->allocate_aligned(rounded, alignment, std::nothrow);
+		SharedObject &obj = shared_object_[id];
+		if (o_ptr == nullptr) {
+			std::cout << "Unable to reallocate the object: " << id << std::endl;
+			obj.lease_state_.store(0, std::memory_order_release);
+			return false;
+		}
+		if (obj.numa_node_ != kSharedNumaNodeNone) {
+			SharedNuma::bind(o_ptr.get(), rounded, obj.numa_node_);
+		}
+		void *old_ptr = obj.ptr();
+		memcpy(o_ptr.get(), old_ptr, std::min(bytes, obj.ptr_size()));
+		init(o_ptr.get());
+		{
+			SharedSeqlockWriteGuard guard(obj.meta_lock_);
+			obj.set_ptr(o_ptr, bytes, alignment);
+		}
+		if (old_ptr != nullptr) segment()->deallocate(old_ptr);
+		obj.lease_state_.store(0, std::memory_order_release);
+		return true;
+	}
+
 	/** @brief Deallocate existing objects
 	*/
 	bool deallocate() {
 		std::cout << "deallocate" << std::endl;
 		std::pair<SharedObject*, std::size_t> p =
-			managed_shm_.find<SharedObject>(shared_object_name_.c_str());
+			segment()->find<SharedObject>(shared_object_name_.c_str());
 
 		for (size_t i = 0; i < p.second; ++i)
 		{
 			//Deallocate it
-			managed_shm_.deallocate(p.first[i].ptr());
+			segment()->deallocate(p.first[i].ptr());
 			// Destroy the pointer
-			managed_shm_.destroy_ptr(p.first);
+			segment()->destroy_ptr(p.first);
 		}
 		return true;
 	}
@@ -304,8 +939,6 @@ public:
 		{
 			// Fill the new shared string
 			shared_object_[id].object_type_ = msg.c_str();
-			// Set the ID of the associated object (fast access)
-			key_id_[msg] = id;
 		}
 	}
 
@@ -316,8 +949,6 @@ public:
 		{
 			// Fill the new shared string
 			shared_object_[id].object_name_ = msg.c_str();
-			// Set the ID of the associated object (fast access)
-			key_id_[msg] = id;
 		}
 	}
 
@@ -350,14 +981,10 @@ public:
 	void object_copyFrom(size_t id, const std::string &msg, std::vector<int> &value) {
 		if (id >= 0 && id < num_items_)
 		{
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
 			// Fill the new shared string
 			shared_object_[id].char_string_ = msg.c_str();
-			// Clear and fill the new vector data
-			shared_object_[id].int_vector_.clear();
-			for (auto it : value)
-			{
-				shared_object_[id].int_vector_.push_back(it);
-			}
+			assign_bulk(shared_object_[id].int_vector_, value.data(), value.size());
 		}
 	}
 
@@ -368,14 +995,10 @@ public:
 	void object_copyFrom(size_t id, const std::string &msg, std::vector<double> &value) {
 		if (id >= 0 && id < num_items_)
 		{
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
 			// Fill the new shared string
 			shared_object_[id].char_string_ = msg.c_str();
-			// Clear and fill the new vector data
-			shared_object_[id].double_vector_.clear();
-			for (auto it : value)
-			{
-				shared_object_[id].double_vector_.push_back(it);
-			}
+			assign_bulk(shared_object_[id].double_vector_, value.data(), value.size());
 		}
 	}
 
@@ -386,12 +1009,8 @@ public:
 	void object_Veci_copyFrom(size_t id, std::vector<int> &value) {
 		if (id >= 0 && id < num_items_)
 		{
-			// Clear and fill the new vector data
-			shared_object_[id].int_vector_.clear();
-			for (auto it : value)
-			{
-				shared_object_[id].int_vector_.push_back(it);
-			}
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
+			assign_bulk(shared_object_[id].int_vector_, value.data(), value.size());
 		}
 	}
 
@@ -401,21 +1020,18 @@ public:
 		@previous set
 	*/
 	void object_Veci_copyFrom(size_t id, const std::vector<int> &value) {
+		object_Veci_copyFrom(id, value.data(), value.size());
+	}
+
+	/** @brief It copies a contiguous range in the int vector.
+
+		The vector is allocated at most once (only if the size changes).
+	*/
+	void object_Veci_copyFrom(size_t id, const int *values, size_t count) {
 		if (id >= 0 && id < num_items_)
 		{
-			// Clear and fill the new vector data if the size is different
-			if (value.size() != shared_object_[id].int_vector_.size()) {
-				shared_object_[id].int_vector_.clear();
-				for (auto it : value)
-				{
-					shared_object_[id].int_vector_.push_back(it);
-				}
-			}
-			else {
-				for (size_t i = 0; i < value.size(); ++i) {
-					shared_object_[id].int_vector_[i] = value[i];
-				}
-			}
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
+			assign_bulk(shared_object_[id].int_vector_, values, count);
 		}
 	}
 
@@ -428,10 +1044,11 @@ public:
 	void object_Veci_modify(size_t id, std::vector<int> &value) {
 		if (id >= 0 && id < num_items_)
 		{
-			if (shared_object_[id].int_vector_.size() == value.size()) {
-				for (size_t i = 0; i < value.size(); ++i) {
-					shared_object_[id].int_vector_[i] = value[i];
-				}
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
+			if (shared_object_[id].int_vector_.size() == value.size() &&
+				!value.empty()) {
+				memcpy(shared_object_[id].int_vector_.data(), value.data(),
+					value.size() * sizeof(int));
 			}
 		}
 	}
@@ -443,6 +1060,7 @@ public:
 		if (id >= 0 && id < num_items_ &&
 			elem_idx < shared_object_[id].int_vector_.size())
 		{
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
 			shared_object_[id].int_vector_[elem_idx] = value;
 		}
 	}
@@ -454,6 +1072,7 @@ public:
 		if (id >= 0 && id < num_items_ &&
 			elem_idx < shared_object_[id].double_vector_.size())
 		{
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
 			shared_object_[id].double_vector_[elem_idx] = value;
 		}
 	}
@@ -505,10 +1124,11 @@ public:
 	void object_Vecd_modify(size_t id, std::vector<double> &value) {
 		if (id >= 0 && id < num_items_)
 		{
-			if (shared_object_[id].double_vector_.size() == value.size()) {
-				for (size_t i = 0; i < value.size(); ++i) {
-					shared_object_[id].double_vector_[i] = value[i];
-				}
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
+			if (shared_object_[id].double_vector_.size() == value.size() &&
+				!value.empty()) {
+				memcpy(shared_object_[id].double_vector_.data(), value.data(),
+					value.size() * sizeof(double));
 			}
 		}
 	}
@@ -522,29 +1142,9 @@ public:
 	void object_Vecd_copyFrom(size_t id, std::vector<double> &value) {
 		if (id >= 0 && id < num_items_)
 		{
-			// Clear and fill the new vector data if the size is different
-			if (value.size() != shared_object_[id].double_vector_.size()) {
-				// Fill the new shared string
-				// Clear and fill the new vector data
-				shared_object_[id].double_vector_.clear();
-				for (auto it : value)
-				{
-					shared_object_[id].double_vector_.push_back(it);
-				}
-			}
-			else {
-				for (size_t i = 0; i < value.size(); ++i) {
-					shared_object_[id].double_vector_[i] = value[i];
-				}
-			}
-
-			//// Fill the new shared string
-			//// Clear and fill the new vector data
-			//shared_object_[id].double_vector_.clear();
-			//for (auto it : value)
-			//{
-			//	shared_object_[id].double_vector_.push_back(it);
-			//}
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
+			assign_bulk(shared_object_[id].double_vector_, value.data(),
+				value.size());
 		}
 	}
 
@@ -554,20 +1154,18 @@ public:
 		@previous set
 	*/
 	void object_Vecd_copyFrom(size_t id, const std::vector<double> &value) {
+		object_Vecd_copyFrom(id, value.data(), value.size());
+	}
+
+	/** @brief It copies a contiguous range in the double vector.
+
+		The vector is allocated at most once (only if the size changes).
+	*/
+	void object_Vecd_copyFrom(size_t id, const double *values, size_t count) {
 		if (id >= 0 && id < num_items_)
 		{
-			// Clear and fill the new vector data if the size is different
-			if (value.size() != shared_object_[id].double_vector_.size()) {
-				shared_object_[id].double_vector_.clear();
-				for (auto it : value)
-				{
-					shared_object_[id].double_vector_.push_back(it);
-				}
-			} else {
-				for (size_t i = 0; i < value.size(); ++i) {
-					shared_object_[id].double_vector_[i] = value[i];
-				}
-			}
+			SharedSeqlockWriteGuard guard(shared_object_[id].meta_lock_);
+			assign_bulk(shared_object_[id].double_vector_, values, count);
 		}
 	}
 
@@ -580,20 +1178,9 @@ public:
 	void object_Vecd_copyTo(size_t id, std::vector<double> &value) {
 		if (id >= 0 && id < num_items_)
 		{
-			// Clear and fill the new vector data if the size is different
-			if (value.size() != shared_object_[id].int_vector_.size()) {
-				// Fill the new shared string
-				// Clear and fill the new vector data
-				value.clear();
-				for (auto it : shared_object_[id].double_vector_)
-				{
-					value.push_back(it);
-				}
-			} else {
-				for (size_t i = 0; i < value.size(); ++i) {
-					value[i] = shared_object_[id].double_vector_[i];
-				}
-			}
+			// The vector is allocated only if the size is different
+			const double *src = shared_object_[id].double_vector_.data();
+			value.assign(src, src + shared_object_[id].double_vector_.size());
 		}
 	}
 
@@ -606,22 +1193,173 @@ public:
 	void object_Veci_copyTo(size_t id, std::vector<int> &value) {
 		if (id >= 0 && id < num_items_)
 		{
-			// Clear and fill the new vector data if the size is different
-			if (value.size() != shared_object_[id].int_vector_.size()) {
-				// Fill the new shared string
-				// Clear and fill the new vector data
-				value.clear();
-				for (auto it : shared_object_[id].int_vector_)
-				{
-					value.push_back(it);
-				}
+			// The vector is allocated only if the size is different
+			const int *src = shared_object_[id].int_vector_.data();
+			value.assign(src, src + shared_object_[id].int_vector_.size());
+		}
+	}
+
+	/** @brief It returns a view of the int vector (no copy).
+
+		@return It returns an empty view if the object does not exist.
+	*/
+	SharedVectorView<int> object_Veci_view(size_t id) const {
+		if (id >= num_items_) return SharedVectorView<int>();
+		const SharedObject &obj = shared_object_[id];
+		return SharedVectorView<int>(obj.int_vector_.data(),
+			obj.int_vector_.size(), &obj.meta_lock_);
+	}
+
+	/** @brief It returns a view of the double vector (no copy).
+
+		@return It returns an empty view if the object does not exist.
+	*/
+	SharedVectorView<double> object_Vecd_view(size_t id) const {
+		if (id >= num_items_) return SharedVectorView<double>();
+		const SharedObject &obj = shared_object_[id];
+		return SharedVectorView<double>(obj.double_vector_.data(),
+			obj.double_vector_.size(), &obj.meta_lock_);
+	}
+
+	/** @brief It modifies several objects as a single transaction.
+
+		All the objects are locked (in order of id) before the first
+		modification and released after the last one, so a reader of an 
+		object never sees a partial update. The update lock of the memory is
+		held for the whole transaction: a reader of several objects can check
+		it with update_lock()->read_begin()/read_retry().
+
+		@return It returns false (and it does not modify anything) if an
+		        object does not exist.
+	*/
+	bool object_update(const std::vector<SharedObjectUpdate> &updates) {
+		std::vector<size_t> ids;
+		ids.reserve(updates.size());
+		for (auto &it : updates) {
+			if (it.id >= num_items_) return false;
+			ids.push_back(it.id);
+		}
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		if (update_lock_ != nullptr) update_lock_->write_begin();
+		for (auto id : ids) shared_object_[id].meta_lock_.write_begin();
+		for (auto &it : updates) {
+			SharedObject &obj = shared_object_[it.id];
+			if (it.int_values != nullptr) {
+				assign_bulk(obj.int_vector_, it.int_values, it.int_count);
 			}
-			else {
-				for (size_t i = 0; i < value.size(); ++i) {
-					value[i] = shared_object_[id].int_vector_[i];
+			if (it.double_values != nullptr) {
+				assign_bulk(obj.double_vector_, it.double_values, 
+					it.double_count);
+			}
+			if (it.msg != nullptr) obj.char_string_ = it.msg;
+		}
+		for (auto it = ids.rbegin(); it != ids.rend(); ++it) {
+			shared_object_[*it].meta_lock_.write_end();
+		}
+		if (update_lock_ != nullptr) update_lock_->write_end();
+		return true;
+	}
+
+	/** @brief Lock held by object_update (shared memory)
+	*/
+	SharedSeqlock* update_lock() const {
+		return update_lock_;
+	}
+
+	/** @brief It takes a consistent snapshot of the int and double vectors.
+
+		It does not lock any mutex. The copy is repeated if a writer modified
+		the vectors in the meantime.
+
+		@param[out] int_values Copy of int_vector_.
+		@param[out] double_values Copy of double_vector_.
+		@return It returns false if the object does not exist or a consistent
+		        copy was not possible in max_retries attempts.
+	*/
+	bool read_consistent(size_t id, std::vector<int> &int_values,
+		std::vector<double> &double_values,
+		int max_retries = kSeqlockMaxRetries) {
+		if (id >= num_items_) return false;
+		const SharedObject &obj = shared_object_[id];
+		for (int retry = 0; retry < max_retries; ++retry) {
+			uint32_t s = obj.meta_lock_.read_begin();
+			size_t num_int = obj.int_vector_.size();
+			size_t num_double = obj.double_vector_.size();
+			const int *src_int = obj.int_vector_.data();
+			const double *src_double = obj.double_vector_.data();
+			// A concurrent reallocation may mix old and new values
+			if (!in_segment(src_int, num_int * sizeof(int)) ||
+				!in_segment(src_double, num_double * sizeof(double))) {
+				if (obj.meta_lock_.read_retry(s)) continue;
+				return false;
+			}
+			int_values.resize(num_int);
+			double_values.resize(num_double);
+			if (num_int > 0) {
+				memcpy(&int_values[0], src_int, num_int * sizeof(int));
+			}
+			if (num_double > 0) {
+				memcpy(&double_values[0], src_double, num_double * sizeof(double));
+			}
+			if (!obj.meta_lock_.read_retry(s)) return true;
+		}
+		return false;
+	}
+
+	/** @brief It takes a consistent snapshot of a range of the int and 
+	           double vectors.
+
+		It does not allocate memory and it does not lock any mutex. 
+		i.e. read_consistent(id, 1, 1, &num_points, 3, 2, time_frame)
+
+		@return It returns false if the object does not exist, a range is
+		        out of the vector or a consistent copy was not possible.
+	*/
+	bool read_consistent(size_t id,
+		size_t int_first, size_t int_count, int *int_values,
+		size_t double_first, size_t double_count, double *double_values,
+		int max_retries = kSeqlockMaxRetries) {
+		if (id >= num_items_) return false;
+		const SharedObject &obj = shared_object_[id];
+		for (int retry = 0; retry < max_retries; ++retry) {
+			uint32_t s = obj.meta_lock_.read_begin();
+			bool valid = 
+				int_first + int_count <= obj.int_vector_.size() &&
+				double_first + double_count <= obj.double_vector_.size();
+			const int *src_int = obj.int_vector_.data() + int_first;
+			const double *src_double = obj.double_vector_.data() + double_first;
+			valid = valid && 
+				in_segment(src_int, int_count * sizeof(int)) &&
+				in_segment(src_double, double_count * sizeof(double));
+			if (valid) {
+				if (int_count > 0) {
+					memcpy(int_values, src_int, int_count * sizeof(int));
+				}
+				if (double_count > 0) {
+					memcpy(double_values, src_double, double_count * sizeof(double));
 				}
 			}
+			if (!obj.meta_lock_.read_retry(s)) return valid;
 		}
+		return false;
+	}
+
+	/** @brief It takes a consistent copy of the header of the last
+	           publication of an object (see SharedObject::publish).
+
+		i.e. a consumer detects the dropped publications and the latency:
+		  SharedObjectHeader header;
+		  if (smm.object_header(id, header)) {
+		    uint64_t dropped = header.sequence - last_sequence - 1;
+		    uint64_t latency = SharedObjectStats::now_ns() - header.timestamp_ns;
+		    last_sequence = header.sequence;
+		  }
+	*/
+	bool object_header(size_t id, SharedObjectHeader &header) {
+		if (id >= num_items_) return false;
+		return shared_object_[id].header(header);
 	}
 
 	/** @brief It sets the pointer data information
@@ -631,7 +1369,17 @@ public:
 	bool object_ptr_copyFrom(size_t id, void *ptr, size_t bytes) {
 		if (id >= 0 && id < num_items_ &&
 			bytes < shared_object_[id].ptr_size()) {
-			memcpy(shared_object_[id].ptr(), ptr, bytes);
+			// the write lease keeps object_reallocate away during the copy
+			SharedObject &obj = shared_object_[id];
+			uint32_t expected = 0;
+			if (!obj.lease_state_.compare_exchange_strong(expected,
+				kSharedLeaseWriter, std::memory_order_acquire)) {
+				return false;
+			}
+			memcpy(obj.ptr(), ptr, bytes);
+			obj.publish(bytes);
+			obj.lease_state_.fetch_and(~kSharedLeaseWriter,
+				std::memory_order_release);
 			return true;
 		}
 		return false;
@@ -644,7 +1392,17 @@ public:
 	bool object_ptr_copyTo(size_t id, void *ptr, size_t bytes) {
 		if (id >= 0 && id < num_items_ &&
 			bytes < shared_object_[id].ptr_size()) {
-			memcpy(ptr, shared_object_[id].ptr(), bytes);
+			// the read lease keeps object_reallocate away during the copy
+			SharedObject &obj = shared_object_[id];
+			uint32_t state = obj.lease_state_.load(std::memory_order_relaxed);
+			do {
+				if (state & (kSharedLeaseWriter | kSharedLeaseResize)) {
+					return false;
+				}
+			} while (!obj.lease_state_.compare_exchange_weak(state, state + 1,
+				std::memory_order_acquire, std::memory_order_relaxed));
+			memcpy(ptr, obj.ptr(), bytes);
+			obj.lease_state_.fetch_sub(1, std::memory_order_release);
 			return true;
 		}
 		return false;
@@ -679,7 +1437,7 @@ public:
 		@previous get
 	*/
 	std::string object_get_string(const std::string &key) {
-		size_t id = key_id_[key];
+		size_t id = key_id(key);
 		if (id >= 0 && id < num_items_)
 		{
 			return std::string(shared_object_[id].char_string_.begin(),
@@ -705,7 +1463,7 @@ public:
 
 	/** @brief Direct access to a shared object
 	*/
-	SharedObject* shared_object(size_t id) const {
+	SharedObject* shared_object(size_t id) {
 		if (id >= 0 && id < num_items_) {
 			return &shared_object_[id];
 		}
@@ -720,14 +1478,70 @@ public:
 	*/
 	boost::interprocess::interprocess_mutex* find_or_create_mutex(
 		const std::string &name) {
-		return managed_shm_.find_or_construct<boost::interprocess::interprocess_mutex>(name.c_str())();
+		return segment()->find_or_construct<boost::interprocess::interprocess_mutex>(name.c_str())();
 	}
 
 	/** @brief It find or create a condition of given name and add to shared memory
 	*/
 	boost::interprocess::interprocess_condition* find_or_create_condition(
 		const std::string &name) {
-		return managed_shm_.find_or_construct<boost::interprocess::interprocess_condition>(name.c_str())();
+		return segment()->find_or_construct<boost::interprocess::interprocess_condition>(name.c_str())();
+	}
+
+	/** @brief It find or create a 32 bits counter of given name and add to 
+	           shared memory
+	*/
+	std::atomic<uint32_t>* find_or_create_counter(
+		const std::string &name) {
+		return segment()->find_or_construct<std::atomic<uint32_t> >(name.c_str())(0);
+	}
+
+	/** @brief It finds a 32 bits counter of given name (nothing is
+	           created)
+
+		@return The counter or nullptr if it does not exist.
+	*/
+	std::atomic<uint32_t>* find_counter(const std::string &name) {
+		return segment()->find<std::atomic<uint32_t> >(name.c_str()).first;
+	}
+
+	/** @brief It find or create a sequence lock of given name and add to
+	           shared memory
+	*/
+	SharedSeqlock* find_or_create_seqlock(const std::string &name) {
+		return segment()->find_or_construct<SharedSeqlock>(name.c_str())();
+	}
+
+	/** @brief It find or create a string of given name and add to shared
+	           memory
+	*/
+	char_string* find_or_create_string(const std::string &name) {
+		void_allocator alloc_inst(segment());
+		return segment()->find_or_construct<char_string>(name.c_str())(
+			alloc_inst);
+	}
+
+	/** @brief It finds a string of given name (nothing is created)
+
+		@return The string or nullptr if it does not exist.
+	*/
+	char_string* find_string(const std::string &name) {
+		return segment()->find<char_string>(name.c_str()).first;
+	}
+
+	/** @brief It find or create a 64 bits value of given name and add to
+	           shared memory
+	*/
+	uint64_t* find_or_create_value64(const std::string &name) {
+		return segment()->find_or_construct<uint64_t>(name.c_str())(0);
+	}
+
+	/** @brief It finds a 64 bits value of given name (nothing is created)
+
+		@return The value or nullptr if it does not exist.
+	*/
+	uint64_t* find_value64(const std::string &name) {
+		return segment()->find<uint64_t>(name.c_str()).first;
 	}
 
 private:
@@ -749,6 +1563,9 @@ private:
 	/** @brief Managed shared memory
 	*/
 	boost::interprocess::managed_shared_memory managed_shm_;
+	/** @brief Managed memory mapped file (SharedMemoryOptions::file)
+	*/
+	boost::interprocess::managed_mapped_file managed_file_;
 
 	/** @brief Shared objects
 	*/
@@ -757,14 +1574,155 @@ private:
 	*/
 	size_t num_items_;
 
+	/** @brief It checks the options before the segment is mapped.
+
+		The alignment must be a non-zero power of two.
+	*/
+	bool check_options(const SharedMemoryOptions &options) const {
+		if (options.alignment == 0 ||
+			(options.alignment & (options.alignment - 1)) != 0) {
+			std::cout << "Invalid alignment (power of 2): " <<
+				options.alignment << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	/** @brief It applies the mapping options to the whole segment
+
+		@param[in] is_creator True if the segment has just been created (no
+		           other process uses it, so the pages can be written).
+	*/
+	void apply_options(const SharedMemoryOptions &options, bool is_creator) {
+		char *address = segment_address();
+		size_t size = segment_size();
+#if defined(__unix__)
+		// the mapping starts at a page boundary
+		size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+		char *begin = reinterpret_cast<char*>(
+			reinterpret_cast<uintptr_t>(address) / page * page);
+		size_t length = size + (address - begin);
+#if defined(MADV_HUGEPAGE)
+		if (options.huge_pages &&
+			madvise(begin, length, MADV_HUGEPAGE) != 0) {
+			std::cout << "Unable to use huge pages: " << shared_memory_name_ <<
+				std::endl;
+		}
+#endif
+#endif
+		if (options.prefault) {
+			bool done = false;
+#if defined(MADV_POPULATE_WRITE)
+			done = madvise(begin, length, MADV_POPULATE_WRITE) == 0;
+#endif
+			if (!done) {
+				// touch each page. Only the creator can write.
+				volatile char *p = address;
+				for (size_t i = 0; i < size; i += 4096) {
+					if (is_creator) {
+						p[i] = p[i];
+					} else {
+						(void)p[i];
+					}
+				}
+			}
+		}
+		if (options.lock_memory) {
+#if defined(__unix__)
+			if (mlock(begin, length) != 0) {
+				std::cout << "Unable to lock the memory: " << 
+					shared_memory_name_ << std::endl;
+			}
+#else
+			std::cout << "Lock of the memory not supported" << std::endl;
+#endif
+		}
+	}
+
+	/** @brief Segment manager of the mapped segment (shared memory or file)
+	*/
+	segment_manager_t* segment() const {
+		return options_.file.empty() ? managed_shm_.get_segment_manager() :
+			managed_file_.get_segment_manager();
+	}
+
+	/** @brief Address of the mapped segment
+	*/
+	char* segment_address() const {
+		return static_cast<char*>(options_.file.empty() ?
+			managed_shm_.get_address() : managed_file_.get_address());
+	}
+
+	/** @brief Size of the mapped segment
+	*/
+	size_t segment_size() const {
+		return options_.file.empty() ? managed_shm_.get_size() :
+			managed_file_.get_size();
+	}
+
+	/** @brief It removes the shared memory or the file of the segment
+	*/
+	bool remove_segment() const {
+		if (!options_.file.empty()) {
+			return boost::interprocess::file_mapping::remove(
+				options_.file.c_str());
+		}
+		return boost::interprocess::shared_memory_object::remove(
+			shared_memory_name_.c_str());
+	}
+
+	/** @brief It returns true if an object has the given name
+	*/
+	bool is_object_name(size_t id, const std::string &key) const {
+		const char_string &obj_name = shared_object_[id].object_name_;
+		return obj_name.size() == key.size() &&
+			memcmp(obj_name.data(), key.data(), key.size()) == 0;
+	}
+
+	/** @brief It returns true if the memory is inside the mapped segment
+	*/
+	bool in_segment(const void *ptr, size_t bytes) const {
+		if (bytes == 0) return true;
+		const char *begin = segment_address();
+		const char *p = static_cast<const char*>(ptr);
+		return p >= begin && bytes <= segment_size() &&
+			p + bytes <= begin + segment_size();
+	}
+
+	/** @brief It copies a contiguous range in a vector of the shared memory.
+
+		If the size is the same the values are copied in place, otherwise
+		the vector is allocated once with the new size.
+	*/
+	template <typename T, typename SharedVector>
+	static void assign_bulk(SharedVector &dst, const T *src, size_t count) {
+		if (dst.size() == count) {
+			if (count > 0) memcpy(dst.data(), src, count * sizeof(T));
+		} else {
+			dst.assign(src, src + count);
+		}
+	}
+
 	/** @brief Access to the managed shared memory
 	*/
 	boost::interprocess::managed_shared_memory& managed_shm() {
 		return managed_shm_;
 	}
 
-	// Container with the key information already assigned
-	std::map<std::string, size_t> key_id_;
+	/** @brief Options used to map the memory and allocate the objects
+	*/
+	SharedMemoryOptions options_;
+
+	/** @brief Hash table with the index of the objects by name (shared memory)
+	*/
+	SharedObjectIndexEntry *index_;
+	/** @brief Number of entries of the hash table (power of 2)
+	*/
+	size_t index_size_;
+
+	/** @brief Lock of the transactions of object_update (shared memory)
+	*/
+	SharedSeqlock *update_lock_;
 };
 
 } // namespace shm
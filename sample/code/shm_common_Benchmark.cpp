@@ -0,0 +1,445 @@
+/**
+* @file shm_common_Benchmark.cpp
+* @brief Latency and throughput of the shared memory between processes.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_common_Benchmark [producers] [consumers] [frames] [max_payload_MB]
+*
+*   Each producer is a process that owns an object and publishes frames.
+*   Each consumer is a process that waits for all the objects, copies every
+*   frame and acknowledges it. The producer publishes the next frame when
+*   all the consumers acknowledged the previous one.
+*   On systems without fork, producers and consumers are threads of this
+*   process (each one with its own mapping of the memory).
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstring>
+#include <cstdlib>
+
+#if defined(__unix__)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "commonobjects/shm_common/SharedDataDerivedSample.hpp"
+
+namespace
+{
+
+/** @brief Name of the shared memory used by the benchmark
+*/
+const char kBenchmarkMemory[] = "shm_common_Benchmark";
+const char kBenchmarkObject[] = "SharedObject";
+
+/** @brief Maximum time to wait the acknowledgement of a frame (ms)
+*/
+const int kAckTimeoutMs = 1000;
+
+/** @brief How the consumers wait for the frames
+*/
+enum BenchmarkMode {
+	kModeCondition = 0, // a thread per object, interprocess condition
+	kModeFutex,         // a thread per object, futex on the object
+	kModeEventLoop      // a few threads for all the objects
+};
+
+/** @brief Configuration of a run
+*/
+struct BenchmarkConfig
+{
+	int num_producers;
+	int num_consumers;
+	int num_frames;
+	int mode;
+	int num_threads;
+	size_t payload;
+};
+
+/** @brief Time since an arbitrary epoch in ns (steady clock, system wide)
+*/
+int64_t now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** @brief Name of the acknowledgement counter of a producer
+*/
+std::string ack_name(size_t id) {
+	return "bench_ack" + std::to_string(id);
+}
+
+/** @brief Consumer side: it copies the frame and measures the latency
+*/
+class FrameCallback
+{
+public:
+
+	FrameCallback(co::shm::SharedMemoryManager &smm,
+		const BenchmarkConfig &config) : config_(config) {
+		for (int i = 0; i < config.num_producers; ++i) {
+			buffers_.push_back(std::vector<char>(config.payload));
+			acks_.push_back(smm.find_or_create_counter(ack_name(i)));
+			last_frame_.push_back(0);
+		}
+		spurious_ = 0;
+		latency_ns_.reserve(config.num_frames * config.num_producers);
+	}
+
+	void my_func(size_t object_id, co::shm::SharedMemoryManager &smm) {
+		size_t size = 0;
+		const char *ptr = static_cast<const char*>(
+			smm.object_get_ptr(object_id, size));
+		if (ptr == nullptr || object_id >= buffers_.size()) return;
+		// header of the frame: time stamp and frame number
+		int64_t stamp = 0, frame = 0;
+		memcpy(&frame, ptr + sizeof(stamp), sizeof(frame));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		memcpy(&stamp, ptr, sizeof(stamp));
+		int64_t latency = now_ns() - stamp;
+		// wake up without a new frame
+		if (frame == last_frame_[object_id]) {
+			++spurious_;
+			return;
+		}
+		last_frame_[object_id] = frame;
+		// each object is processed by one thread at a time
+		memcpy(buffers_[object_id].data(), ptr, config_.payload);
+		{
+			std::lock_guard<std::mutex> lock(mtx_);
+			latency_ns_.push_back(latency);
+		}
+		acks_[object_id]->fetch_add(1, std::memory_order_release);
+	}
+
+	BenchmarkConfig config_;
+	std::vector<std::vector<char> > buffers_;
+	std::vector<std::atomic<uint32_t>*> acks_;
+	std::vector<int64_t> last_frame_;
+	std::atomic<int> spurious_;
+	std::mutex mtx_;
+	std::vector<int64_t> latency_ns_;
+};
+
+/** @brief Consumer process. It returns the latencies measured.
+
+	@param[out] spurious Callbacks without a new frame.
+*/
+std::vector<int64_t> run_consumer(const BenchmarkConfig &config,
+	int &spurious) {
+	spurious = 0;
+	co::shm::SharedDataDerivedSample consumer;
+	if (!consumer.detect(kBenchmarkMemory, kBenchmarkObject)) {
+		return std::vector<int64_t>();
+	}
+	consumer.set_notification_mode(config.mode == kModeCondition ?
+		co::shm::kNotificationCondition : co::shm::kNotificationFutex);
+	FrameCallback callback(consumer.smm(), config);
+	consumer.registerCallback(std::bind(&FrameCallback::my_func,
+		std::ref(callback), std::placeholders::_1, std::placeholders::_2));
+	std::vector<size_t> which;
+	for (int i = 0; i < config.num_producers; ++i) which.push_back(i);
+	if (config.mode == kModeEventLoop) {
+		consumer.start_event_loop(which, config.num_threads,
+			co::shm::kThreadPriorityNone);
+	} else {
+		consumer.start(which, co::shm::kThreadPriorityNone);
+	}
+	// let the threads wait
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	std::atomic<uint32_t> *ready = consumer.smm().find_or_create_counter(
+		"bench_ready");
+	std::atomic<uint32_t> *stop = consumer.smm().find_or_create_counter(
+		"bench_stop");
+	ready->fetch_add(1);
+	while (stop->load() == 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	consumer.stop();
+	spurious = callback.spurious_.load();
+	std::lock_guard<std::mutex> lock(callback.mtx_);
+	return callback.latency_ns_;
+}
+
+/** @brief Producer process. It returns the number of frames not
+           acknowledged by all the consumers in time.
+*/
+int run_producer(const BenchmarkConfig &config, size_t id_obj) {
+	co::shm::SharedDataDerivedSample producer;
+	if (!producer.detect(kBenchmarkMemory, kBenchmarkObject)) {
+		return config.num_frames;
+	}
+	std::atomic<uint32_t> *ack = producer.smm().find_or_create_counter(
+		ack_name(id_obj));
+	std::vector<char> payload(config.payload, static_cast<char>(id_obj));
+	const size_t header = 2 * sizeof(int64_t);
+	int timeouts = 0;
+	for (int i = 0; i < config.num_frames; ++i) {
+		size_t size = 0;
+		char *ptr = static_cast<char*>(
+			producer.smm().object_get_ptr(id_obj, size));
+		memcpy(ptr + header, payload.data() + header, config.payload - header);
+		int64_t stamp = now_ns(), frame = i + 1;
+		memcpy(ptr, &stamp, sizeof(stamp));
+		std::atomic_thread_fence(std::memory_order_release);
+		memcpy(ptr + sizeof(stamp), &frame, sizeof(frame));
+		producer.notify_object(id_obj);
+		uint32_t expected = static_cast<uint32_t>(
+			(i + 1) * config.num_consumers);
+		int64_t deadline = now_ns() + kAckTimeoutMs * 1000000LL;
+		while (ack->load(std::memory_order_acquire) < expected) {
+			if (now_ns() > deadline) {
+				++timeouts;
+				// skip the missing acknowledgements
+				ack->store(expected);
+				break;
+			}
+			std::this_thread::yield();
+		}
+	}
+	return timeouts;
+}
+
+#if defined(__unix__)
+/** @brief It writes all the bytes to a pipe
+*/
+void write_all(int fd, const void *data, size_t bytes) {
+	const char *p = static_cast<const char*>(data);
+	while (bytes > 0) {
+		ssize_t n = write(fd, p, bytes);
+		if (n <= 0) return;
+		p += n;
+		bytes -= n;
+	}
+}
+
+/** @brief It reads all the bytes from a pipe
+*/
+bool read_all(int fd, void *data, size_t bytes) {
+	char *p = static_cast<char*>(data);
+	while (bytes > 0) {
+		ssize_t n = read(fd, p, bytes);
+		if (n <= 0) return false;
+		p += n;
+		bytes -= n;
+	}
+	return true;
+}
+#endif
+
+/** @brief It runs a configuration and prints a line of the report
+*/
+void run(const BenchmarkConfig &config) {
+	// one object per producer
+	std::string msg;
+	for (int i = 0; i < config.num_producers; ++i) {
+		if (i > 0) msg += "|";
+		msg += "image,p" + std::to_string(i) + "," +
+			std::to_string(config.payload) + ",1,1";
+	}
+	co::shm::SharedDataDerivedSample creator;
+	if (creator.parse(kBenchmarkMemory, kBenchmarkObject, msg) !=
+		co::shm::kSharedNoError) {
+		std::cout << "[e] unable to create the shared memory" << std::endl;
+		return;
+	}
+	std::atomic<uint32_t> *ready = creator.smm().find_or_create_counter(
+		"bench_ready");
+	std::atomic<uint32_t> *stop = creator.smm().find_or_create_counter(
+		"bench_stop");
+	for (int i = 0; i < config.num_producers; ++i) {
+		creator.smm().find_or_create_counter(ack_name(i));
+	}
+
+	std::vector<int64_t> latency_ns;
+	int timeouts = 0;
+	int spurious = 0;
+	int64_t elapsed_ns = 0;
+
+#if defined(__unix__)
+	std::vector<int> fds;
+	std::vector<pid_t> consumers;
+	for (int i = 0; i < config.num_consumers; ++i) {
+		int fd[2];
+		if (pipe(fd) != 0) return;
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(fd[0]);
+			int s = 0;
+			std::vector<int64_t> v = run_consumer(config, s);
+			uint64_t n = v.size();
+			write_all(fd[1], &s, sizeof(s));
+			write_all(fd[1], &n, sizeof(n));
+			write_all(fd[1], v.data(), n * sizeof(int64_t));
+			close(fd[1]);
+			// skip the destructors of the parent objects
+			_exit(0);
+		}
+		close(fd[1]);
+		fds.push_back(fd[0]);
+		consumers.push_back(pid);
+	}
+	int64_t deadline = now_ns() + 5000000000LL;
+	while (ready->load() < static_cast<uint32_t>(config.num_consumers) &&
+		now_ns() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	int64_t t0 = now_ns();
+	std::vector<pid_t> producers;
+	for (int i = 0; i < config.num_producers; ++i) {
+		pid_t pid = fork();
+		if (pid == 0) {
+			_exit(std::min(run_producer(config, i), 255));
+		}
+		producers.push_back(pid);
+	}
+	for (auto &it : producers) {
+		int status = 0;
+		waitpid(it, &status, 0);
+		if (WIFEXITED(status)) timeouts += WEXITSTATUS(status);
+	}
+	elapsed_ns = now_ns() - t0;
+	stop->store(1);
+	creator.notify_objects();
+	for (size_t i = 0; i < fds.size(); ++i) {
+		uint64_t n = 0;
+		int s = 0;
+		if (read_all(fds[i], &s, sizeof(s)) && read_all(fds[i], &n, sizeof(n))) {
+			spurious += s;
+			std::vector<int64_t> v(static_cast<size_t>(n));
+			if (read_all(fds[i], v.data(), v.size() * sizeof(int64_t))) {
+				latency_ns.insert(latency_ns.end(), v.begin(), v.end());
+			}
+		}
+		close(fds[i]);
+		waitpid(consumers[i], nullptr, 0);
+	}
+#else
+	std::vector<std::vector<int64_t> > results(config.num_consumers);
+	std::vector<int> consumer_spurious(config.num_consumers, 0);
+	std::vector<std::thread> consumers;
+	for (int i = 0; i < config.num_consumers; ++i) {
+		consumers.push_back(std::thread(
+			[&config, &results, &consumer_spurious, i]() {
+			results[i] = run_consumer(config, consumer_spurious[i]);
+		}));
+	}
+	int64_t deadline = now_ns() + 5000000000LL;
+	while (ready->load() < static_cast<uint32_t>(config.num_consumers) &&
+		now_ns() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	int64_t t0 = now_ns();
+	std::vector<int> producer_timeouts(config.num_producers, 0);
+	std::vector<std::thread> producers;
+	for (int i = 0; i < config.num_producers; ++i) {
+		producers.push_back(std::thread([&config, &producer_timeouts, i]() {
+			producer_timeouts[i] = run_producer(config, i);
+		}));
+	}
+	for (auto &it : producers) it.join();
+	elapsed_ns = now_ns() - t0;
+	stop->store(1);
+	creator.notify_objects();
+	for (auto &it : consumers) it.join();
+	for (auto &it : producer_timeouts) timeouts += it;
+	for (auto &it : consumer_spurious) spurious += it;
+	for (auto &it : results) {
+		latency_ns.insert(latency_ns.end(), it.begin(), it.end());
+	}
+#endif
+
+	const char *mode_name[] = { "condition", "futex", "event_loop" };
+	std::cout << std::setw(11) << mode_name[config.mode] <<
+		std::setw(4) << config.num_threads <<
+		std::setw(10) << config.payload <<
+		std::setw(4) << config.num_producers <<
+		std::setw(4) << config.num_consumers;
+	if (latency_ns.empty()) {
+		std::cout << "  no frame received" << std::endl;
+		return;
+	}
+	std::sort(latency_ns.begin(), latency_ns.end());
+	size_t n = latency_ns.size();
+	double gbps = elapsed_ns > 0 ? static_cast<double>(n) * config.payload /
+		elapsed_ns : 0;
+	std::cout << std::fixed << std::setprecision(1) <<
+		std::setw(9) << n <<
+		std::setw(10) << latency_ns[n / 2] / 1000.0 <<
+		std::setw(10) << latency_ns[n * 99 / 100] / 1000.0 <<
+		std::setw(10) << latency_ns[n * 999 / 1000] / 1000.0 <<
+		std::setprecision(3) << std::setw(9) << gbps <<
+		std::setw(6) << timeouts << std::setw(9) << spurious << std::endl;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	std::cout << "shm_common_Benchmark" << std::endl;
+
+	BenchmarkConfig config;
+	config.num_producers = argc > 1 ? std::atoi(argv[1]) : 1;
+	config.num_consumers = argc > 2 ? std::atoi(argv[2]) : 2;
+	config.num_frames = argc > 3 ? std::atoi(argv[3]) : 200;
+	size_t max_payload = (argc > 4 ? std::atoi(argv[4]) : 25) * 1024 * 1024;
+	if (config.num_producers < 1 || config.num_consumers < 1 ||
+		config.num_frames < 1) {
+		std::cout << "usage: shm_common_Benchmark [producers] [consumers] "
+			"[frames] [max_payload_MB]" << std::endl;
+		return 1;
+	}
+
+	// pose, small image, VGA RGB, 1080p RGB, 4K RGBD
+	const size_t payloads[] = { 1024, 65536, 640 * 480 * 3, 1920 * 1080 * 3,
+		25 * 1024 * 1024 };
+
+	// the report is printed after the logs of the shared memory
+	std::cout << "       mode thr   payload  np  nc   frames   p50(us)   " <<
+		"p99(us) p99.9(us)     GB/s  lost spurious" << std::endl;
+	for (auto payload : payloads) {
+		if (payload > max_payload) continue;
+		config.payload = payload;
+		config.num_threads = 1;
+		config.mode = kModeCondition;
+		run(config);
+		if (co::shm::SharedNotifier::is_futex_available()) {
+			config.mode = kModeFutex;
+			run(config);
+		}
+		config.mode = kModeEventLoop;
+		for (int threads = 1; threads <= config.num_producers; threads *= 2) {
+			config.num_threads = threads;
+			run(config);
+		}
+	}
+	return 0;
+}
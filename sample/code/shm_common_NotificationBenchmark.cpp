@@ -0,0 +1,144 @@
+/**
+* @file shm_common_NotificationBenchmark.cpp
+* @brief Wake-to-callback latency of the shared memory notification backends.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+*/
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstring>
+
+#include "commonobjects/shm_common/SharedDataDerivedSample.hpp"
+
+namespace
+{
+
+/** @brief Number of notifications measured for each backend
+*/
+const int kNumSamples = 2000;
+
+/** @brief Time since an arbitrary epoch in ns (steady clock)
+*/
+int64_t now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** @brief Consumer side of the benchmark
+*/
+class LatencyCallback
+{
+public:
+
+	LatencyCallback() : received_(0) {}
+
+	/** @brief It reads the time stamp written by the producer
+	*/
+	void my_func(size_t object_id, co::shm::SharedMemoryManager &smm) {
+		size_t size = 0;
+		int64_t stamp = 0;
+		memcpy(&stamp, smm.object_get_ptr(object_id, size), sizeof(stamp));
+		latency_ns_.push_back(now_ns() - stamp);
+		received_.fetch_add(1);
+	}
+
+	std::vector<int64_t> latency_ns_;
+	std::atomic<int> received_;
+};
+
+/** @brief It measures the latency of a notification mode
+*/
+void benchmark(co::shm::SharedDataDerivedSample &producer, size_t key_ping,
+	int mode, const std::string &mode_name) {
+
+	co::shm::SharedDataDerivedSample consumer;
+	if (!consumer.detect("NotificationBenchmark", "SharedObject")) return;
+	if (!consumer.set_notification_mode(mode)) {
+		std::cout << mode_name << ": not supported" << std::endl;
+		return;
+	}
+	LatencyCallback callback;
+	callback.latency_ns_.reserve(kNumSamples);
+	consumer.registerCallback(std::bind(&LatencyCallback::my_func,
+		std::ref(callback), std::placeholders::_1, std::placeholders::_2));
+	std::vector<size_t> which = { key_ping };
+	consumer.start(which, co::shm::kThreadPriorityNone);
+	// let the consumer wait
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	size_t size = 0;
+	void *ptr = producer.object_get_ptr(key_ping, size);
+	for (int i = 0; i < kNumSamples; ++i) {
+		int expected = callback.received_.load() + 1;
+		int64_t stamp = now_ns();
+		memcpy(ptr, &stamp, sizeof(stamp));
+		producer.notify_object(key_ping);
+		// wait the callback (a lost notification is skipped after 10ms)
+		int64_t deadline = now_ns() + 10000000;
+		while (callback.received_.load() < expected && now_ns() < deadline) {
+			std::this_thread::yield();
+		}
+		// the consumer goes back to wait
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+	consumer.stop();
+
+	std::vector<int64_t> &v = callback.latency_ns_;
+	if (v.empty()) {
+		std::cout << mode_name << ": no callback received" << std::endl;
+		return;
+	}
+	std::sort(v.begin(), v.end());
+	std::cout << mode_name << " samples: " << v.size() << "/" << kNumSamples <<
+		" min(us): " << v.front() / 1000.0 <<
+		" p50(us): " << v[v.size() / 2] / 1000.0 <<
+		" p99(us): " << v[v.size() * 99 / 100] / 1000.0 <<
+		" max(us): " << v.back() / 1000.0 << std::endl;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main()
+{
+	std::cout << "shm_common_NotificationBenchmark" << std::endl;
+
+	co::shm::SharedDataDerivedSample producer;
+	int err = producer.parse("NotificationBenchmark", "SharedObject",
+		"yolo,ping");
+	if (err != co::shm::kSharedNoError) {
+		std::cout << "shared_data error: " << err << std::endl;
+		return 1;
+	}
+	size_t key_ping = producer.get_key_id("ping");
+	if (key_ping == co::shm::kInvalidKeyID) {
+		std::cout << "[e] Shared memory has memory for the ping" << std::endl;
+		return 1;
+	}
+
+	benchmark(producer, key_ping, co::shm::kNotificationCondition, "condition");
+	benchmark(producer, key_ping, co::shm::kNotificationFutex, "futex");
+	return 0;
+}
@@ -0,0 +1,97 @@
+/**
+* @file shm_common_shm_bridge.cpp
+* @brief It forwards the objects of a shared memory to remote processes, and
+*        it recreates the memory on the remote side.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_bridge serve <memory_name> <address> [object_name=SharedObject]
+*                    [objects=all (i.e. rgb,depth)]
+*                    [compressed=none (i.e. depth)]
+*   shm_bridge receive <address> <memory_name>
+*
+*   An address is <host>:<port> (TCP, i.e. 127.0.0.1:5000 or :5000 to
+*   listen on all the interfaces) or unix:<path>.
+*   serve attaches to the memory and forwards the chosen objects to the
+*   connected receivers. receive creates a memory with the same layout and
+*   publishes the objects received, so its processes do not change.
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+
+#include "commonobjects/shm_common/SharedBridge.hpp"
+
+namespace
+{
+
+/** @brief It splits a list of names separated by comma
+*/
+std::vector<std::string> split(const std::string &list) {
+	std::vector<std::string> names;
+	if (list == "all" || list == "none") return names;
+	std::stringstream ss(list);
+	std::string name;
+	while (std::getline(ss, name, ',')) {
+		if (!name.empty()) names.push_back(name);
+	}
+	return names;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+#if defined(__unix__)
+	std::string mode = argc > 1 ? argv[1] : "";
+	if (mode == "serve" && argc >= 4) {
+		co::shm::SharedBridgeServer bridge;
+		if (!bridge.open(argv[2], argc > 4 ? argv[4] : "SharedObject", argv[3],
+			split(argc > 5 ? argv[5] : "all"),
+			split(argc > 6 ? argv[6] : "none"))) {
+			std::cout << "[e] Unable to serve: " << argv[2] << std::endl;
+			return 1;
+		}
+		std::cout << "Serving " << argv[2] << " on " << argv[3] << std::endl;
+		bridge.run();
+		return 0;
+	}
+	if (mode == "receive" && argc >= 4) {
+		co::shm::SharedBridgeClient bridge;
+		if (!bridge.open(argv[2], argv[3])) {
+			std::cout << "[e] Unable to receive: " << argv[2] << std::endl;
+			return 1;
+		}
+		std::cout << "Receiving " << argv[3] << " from " << argv[2] << std::endl;
+		bridge.run();
+		return 0;
+	}
+	std::cout << "usage: shm_bridge serve <memory_name> <address> " <<
+		"[object_name] [objects] [compressed]" << std::endl;
+	std::cout << "       shm_bridge receive <address> <memory_name>" <<
+		std::endl;
+#else
+	std::cout << "The bridge needs the POSIX sockets" << std::endl;
+#endif
+	return 1;
+}
@@ -0,0 +1,64 @@
+/**
+* @file shm_common_shm_checkpoint.cpp
+* @brief It saves a snapshot of a shared memory in a file.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_checkpoint <memory_name> <snapshot_file> [object_name=SharedObject]
+*                  [segment_file]
+*
+*   It attaches to the memory (or to the memory mapped file segment_file)
+*   and copies the whole segment in snapshot_file. The snapshot can be
+*   opened later as a segment file (SharedMemoryOptions::file).
+*   If snapshot_file is "-" a segment file is only flushed (msync).
+*/
+
+#include <iostream>
+#include <string>
+
+#include "commonobjects/shm_common/doc_managedmemory_shared_data_base.hpp"
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		std::cout << "usage: shm_checkpoint <memory_name> <snapshot_file> " <<
+			"[object_name] [segment_file]" << std::endl;
+		return 1;
+	}
+	std::string name_shm = argv[1];
+	std::string snapshot = argv[2];
+	std::string name_object = argc > 3 ? argv[3] : "SharedObject";
+	co::shm::SharedMemoryOptions options;
+	if (argc > 4) options.file = argv[4];
+
+	co::shm::SharedMemoryManager smm;
+	if (!smm.detect(name_shm, name_object, options)) {
+		std::cout << "[e] Unable to detect: " << name_shm << std::endl;
+		return 1;
+	}
+	if (!smm.checkpoint(snapshot == "-" ? std::string() : snapshot)) {
+		std::cout << "[e] Unable to save the checkpoint" << std::endl;
+		return 1;
+	}
+	std::cout << "Checkpoint of " << smm.num_items() << " objects: " <<
+		(snapshot == "-" ? options.file : snapshot) << std::endl;
+	return 0;
+}
@@ -0,0 +1,136 @@
+/**
+* @file shm_common_shm_lease.cpp
+* @brief Readers that hold leases on a triple buffered image while it is written.
+*        replays them in a new memory at the original rate.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_lease [readers=4] [seconds=5] [memory_name=LeaseMemory]
+*
+*   A producer writes frames filled with a single value in a triple
+*   buffered image as fast as it can. Each reader attaches to the memory,
+*   holds read leases for a random time and checks that the pinned frame
+*   never changes (the frame would be torn). It returns 1 if a frame tore.
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+
+#include "commonobjects/shm_common/SharedDataDerivedSample.hpp"
+
+namespace
+{
+
+// Size of the image
+const int kWidth = 320;
+const int kHeight = 240;
+const int kChannels = 3;
+
+/** @brief It returns true if all the bytes of the frame have the same value
+*/
+bool is_uniform(const unsigned char *data, size_t bytes) {
+	return bytes == 0 || std::memcmp(data, data + 1, bytes - 1) == 0;
+}
+
+/** @brief It holds read leases and checks the pinned frames
+*/
+void reader(const std::string &name_shm, int seed,
+	const std::atomic<bool> &stop,
+	std::atomic<size_t> &num_leases, std::atomic<size_t> &num_torn) {
+	co::shm::SharedDataDerivedSample shared_data;
+	if (!shared_data.detect(name_shm, "SharedObject")) {
+		std::cout << "[e] Unable to detect: " << name_shm << std::endl;
+		return;
+	}
+	size_t id = shared_data.get_key_id("rgb");
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<int> hold_us(0, 2000);
+	while (!stop) {
+		size_t bytes = 0;
+		const unsigned char *data = static_cast<const unsigned char*>(
+			shared_data.object_acquire_read(id, bytes));
+		if (data == nullptr) {
+			std::this_thread::yield();
+			continue;
+		}
+		unsigned char value = data[0];
+		bool is_torn = !is_uniform(data, bytes);
+		std::this_thread::sleep_for(std::chrono::microseconds(hold_us(rng)));
+		// the pinned frame must not change while the lease is held
+		is_torn = is_torn || data[0] != value || !is_uniform(data, bytes);
+		shared_data.object_release_read(id, data);
+		++num_leases;
+		if (is_torn) ++num_torn;
+	}
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	int num_readers = argc > 1 ? std::atoi(argv[1]) : 4;
+	int seconds = argc > 2 ? std::atoi(argv[2]) : 5;
+	std::string name_shm = argc > 3 ? argv[3] : "LeaseMemory";
+
+	co::shm::SharedDataDerivedSample shared_data;
+	if (shared_data.parse(name_shm, "SharedObject", "image,rgb," +
+		std::to_string(kWidth) + "," + std::to_string(kHeight) + "," +
+		std::to_string(kChannels) + ",triple") != co::shm::kSharedNoError) {
+		std::cout << "[e] Unable to create: " << name_shm << std::endl;
+		return 1;
+	}
+	size_t id = shared_data.get_key_id("rgb");
+
+	std::atomic<bool> stop(false);
+	std::atomic<size_t> num_leases(0), num_torn(0);
+	std::vector<std::thread> readers;
+	for (int i = 0; i < num_readers; ++i) {
+		readers.push_back(std::thread(reader, name_shm, i, std::cref(stop),
+			std::ref(num_leases), std::ref(num_torn)));
+	}
+
+	std::vector<unsigned char> frame(kWidth * kHeight * kChannels);
+	size_t num_frames = 0, num_refused = 0;
+	auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+	while (std::chrono::steady_clock::now() < end) {
+		std::fill(frame.begin(), frame.end(),
+			static_cast<unsigned char>(num_frames));
+		if (shared_data.image_copyFrom(id, frame.data(), frame.size())) {
+			++num_frames;
+		} else {
+			// the readers pin all the free buffers
+			++num_refused;
+		}
+	}
+	stop = true;
+	for (auto &it : readers) it.join();
+
+	std::cout << "Frames: " << num_frames << " refused: " << num_refused <<
+		" leases: " << num_leases << " torn: " << num_torn << std::endl;
+	return num_torn == 0 ? 0 : 1;
+}
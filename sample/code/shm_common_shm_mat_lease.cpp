@@ -0,0 +1,113 @@
+/**
+* @file shm_common_shm_mat_lease.cpp
+* @brief Read and write leases of the shared images as cv::Mat.
+*        replays them in a new memory at the original rate.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_mat_lease [memory_name=MatLeaseMemory]
+*
+*   It creates a single buffered and a triple buffered image, fills them
+*   with a write lease and checks them with a read lease. A single
+*   buffered image refuses the writer while a read lease is held. It
+*   returns 1 if a check fails.
+*/
+
+#include <iostream>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+#include "commonobjects/shm_common/SharedDataDerivedSample.hpp"
+#include "commonobjects/shm_common/SharedMatLease.hpp"
+
+namespace
+{
+
+/** @brief It writes a color with a write lease and reads it back
+*/
+bool write_read(co::shm::SharedDataDerivedSample &shared_data, size_t id,
+	const cv::Scalar &color) {
+	{
+		co::shm::SharedMatWriteLease lease(shared_data, id);
+		if (!lease.is_valid()) {
+			std::cout << "[e] Unable to acquire the write lease " << id <<
+				std::endl;
+			return false;
+		}
+		// the header is over the shared memory, it must not be reassigned
+		lease.mat().setTo(color);
+	}
+	co::shm::SharedMatReadLease lease(shared_data, id);
+	if (!lease.is_valid()) {
+		std::cout << "[e] Unable to acquire the read lease " << id <<
+			std::endl;
+		return false;
+	}
+	cv::Mat expected(lease.mat().size(), lease.mat().type(), color);
+	if (cv::norm(lease.mat(), expected, cv::NORM_INF) != 0) {
+		std::cout << "[e] The image " << id << " is not the one written" <<
+			std::endl;
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	std::string name_shm = argc > 1 ? argv[1] : "MatLeaseMemory";
+	co::shm::SharedDataDerivedSample shared_data;
+	if (shared_data.parse(name_shm, "SharedObject",
+		"image,rgb,640,480,3|image,depth,320,240,1,triple") !=
+		co::shm::kSharedNoError) {
+		std::cout << "[e] Unable to create: " << name_shm << std::endl;
+		return 1;
+	}
+	size_t id_rgb = shared_data.get_key_id("rgb");
+	size_t id_depth = shared_data.get_key_id("depth");
+
+	bool is_ok = write_read(shared_data, id_rgb, cv::Scalar(10, 20, 30)) &&
+		write_read(shared_data, id_depth, cv::Scalar(40));
+
+	// a read lease pins the single buffered image
+	{
+		co::shm::SharedMatReadLease lease(shared_data, id_rgb);
+		co::shm::SharedMatWriteLease writer(shared_data, id_rgb);
+		if (!lease.is_valid() || writer.is_valid()) {
+			std::cout << "[e] The read lease does not pin the image" <<
+				std::endl;
+			is_ok = false;
+		}
+	}
+	// a read lease of the triple buffered image does not block the writer
+	{
+		co::shm::SharedMatReadLease lease(shared_data, id_depth);
+		is_ok = write_read(shared_data, id_depth, cv::Scalar(50)) && is_ok;
+		if (!lease.is_valid() || lease.mat().at<unsigned char>(0, 0) != 40) {
+			std::cout << "[e] The pinned frame changed" << std::endl;
+			is_ok = false;
+		}
+	}
+	std::cout << (is_ok ? "Leases ok" : "Leases failed") << std::endl;
+	return is_ok ? 0 : 1;
+}
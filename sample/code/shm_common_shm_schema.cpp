@@ -0,0 +1,136 @@
+/**
+* @file shm_common_shm_schema.cpp
+* @brief Producer and consumer of a memory described by a schema.
+*        replays them in a new memory at the original rate.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_schema producer [memory_name=SchemaMemory] [frames=100]
+*   shm_schema consumer [memory_name=SchemaMemory] [seconds=10]
+*
+*   producer creates the memory with parse_schema and publishes an image
+*   and a point cloud every 33 ms.
+*   consumer attaches with detect_schema (it fails if the producer uses
+*   another layout), listens for the objects and reads them.
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+
+#include "commonobjects/shm_common/SharedSchema.hpp"
+
+namespace
+{
+
+CO_SHM_SCHEMA_NAME(RgbName, "rgb");
+CO_SHM_SCHEMA_NAME(CloudName, "cloud");
+typedef co::shm::SharedImageDesc<RgbName, 320, 240, 3> Rgb;
+typedef co::shm::SharedPclDesc<CloudName, 16, 10000> Cloud;
+typedef co::shm::SharedSchema<Rgb, Cloud> DemoSchema;
+
+/** @brief It publishes frames of the schema
+*/
+int producer(const std::string &name_shm, int frames) {
+	co::shm::SharedDataDerivedSample shared_data;
+	if (shared_data.parse_schema<DemoSchema>(name_shm, "SharedObject") !=
+		co::shm::kSharedNoError) {
+		std::cout << "[e] Unable to create: " << name_shm << std::endl;
+		return 1;
+	}
+	co::shm::SharedSchemaObject<DemoSchema, Rgb> rgb(shared_data);
+	co::shm::SharedSchemaObject<DemoSchema, Cloud> cloud(shared_data);
+
+	std::vector<unsigned char> image(Rgb::raw_bytes());
+	std::vector<unsigned char> points(Cloud::raw_bytes());
+	for (int i = 0; i < frames; ++i) {
+		std::fill(image.begin(), image.end(), static_cast<unsigned char>(i));
+		int num_points = 1 + i % 10000;
+		std::fill(points.begin(), points.begin() + num_points * 16,
+			static_cast<unsigned char>(i));
+		if (!rgb.write(image.data())) {
+			std::cout << "[w] Unable to write the image " << i << std::endl;
+		}
+		if (!cloud.write(points.data(), num_points)) {
+			std::cout << "[w] Unable to write the cloud " << i << std::endl;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(33));
+	}
+	std::cout << "Published " << frames << " frames" << std::endl;
+	return 0;
+}
+
+/** @brief It reads the frames of the schema
+*/
+int consumer(const std::string &name_shm, int seconds) {
+	co::shm::SharedDataDerivedSample shared_data;
+	if (!shared_data.detect_schema<DemoSchema>(name_shm, "SharedObject")) {
+		std::cout << "[e] Unable to detect: " << name_shm << std::endl;
+		return 1;
+	}
+	co::shm::SharedSchemaObject<DemoSchema, Rgb> rgb(shared_data);
+	co::shm::SharedSchemaObject<DemoSchema, Cloud> cloud(shared_data);
+
+	// the callbacks of the objects run in different threads
+	std::atomic<int> num_images(0), num_clouds(0);
+	std::vector<unsigned char> image(Rgb::raw_bytes());
+	std::vector<unsigned char> points(Cloud::raw_bytes());
+	shared_data.registerCallback([&](size_t id,
+		co::shm::SharedMemoryManager &) {
+		if (id == rgb.id()) {
+			if (rgb.read(image.data())) ++num_images;
+		} else if (id == cloud.id()) {
+			int num_points = 0;
+			if (cloud.read(points.data(), num_points)) ++num_clouds;
+		}
+	});
+	std::vector<size_t> which({ rgb.id(), cloud.id() });
+	shared_data.start(which, 0);
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	shared_data.stop();
+	std::cout << "Read " << num_images << " images and " << num_clouds <<
+		" clouds" << std::endl;
+	return 0;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	std::string mode = argc > 1 ? argv[1] : "";
+	std::string name_shm = argc > 2 ? argv[2] : "SchemaMemory";
+	if (mode == "producer") {
+		return producer(name_shm, argc > 3 ? std::atoi(argv[3]) : 100);
+	}
+	if (mode == "consumer") {
+		return consumer(name_shm, argc > 3 ? std::atoi(argv[3]) : 10);
+	}
+	std::cout << "usage: shm_schema producer [memory_name] [frames]" <<
+		std::endl;
+	std::cout << "       shm_schema consumer [memory_name] [seconds]" <<
+		std::endl;
+	return 1;
+}
@@ -0,0 +1,127 @@
+/**
+* @file shm_common_shm_stat.cpp
+* @brief It prints the live statistics of the objects of a shared memory.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_stat <memory_name> [object_name=SharedObject] [period_ms=1000]
+*            [iterations=0 (forever)]
+*
+*   It attaches to the memory without creating any object, and it prints
+*   the counters of each object every period.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+
+#include "commonobjects/shm_common/doc_managedmemory_shared_data_base.hpp"
+
+namespace
+{
+
+/** @brief Counters of an object at the previous print
+*/
+struct ObjectSnapshot
+{
+	ObjectSnapshot() : write_count(0), bytes_written(0) {}
+
+	uint64_t write_count;
+	uint64_t bytes_written;
+};
+
+/** @brief It prints a line for each object
+*/
+void print_stats(co::shm::SharedMemoryManager &smm,
+	std::vector<ObjectSnapshot> &previous, double period_s) {
+	std::cout << std::setw(4) << "id" << std::setw(16) << "name" <<
+		std::setw(12) << "type" << std::setw(12) << "writes" <<
+		std::setw(10) << "writes/s" << std::setw(10) << "MB/s" <<
+		std::setw(12) << "last(ms)" << std::setw(12) << "callbacks" <<
+		std::setw(10) << "missed" << std::setw(14) << "max_cb(us)" <<
+		std::endl;
+	uint64_t now = co::shm::SharedObjectStats::now_ns();
+	for (size_t i = 0; i < smm.num_items(); ++i) {
+		co::shm::SharedObject *obj = smm.shared_object(i);
+		if (obj == nullptr) continue;
+		const co::shm::SharedObjectStats &stats = obj->stats_;
+		uint64_t writes = stats.write_count.load();
+		uint64_t bytes = stats.bytes_written.load();
+		uint64_t last = stats.last_write_ns.load();
+		double writes_s = (writes - previous[i].write_count) / period_s;
+		double mb_s = (bytes - previous[i].bytes_written) / period_s / 1e6;
+		previous[i].write_count = writes;
+		previous[i].bytes_written = bytes;
+		std::cout << std::setw(4) << i <<
+			std::setw(16) << obj->object_name_.c_str() <<
+			std::setw(12) << obj->object_type_.c_str() <<
+			std::setw(12) << writes <<
+			std::fixed << std::setprecision(1) <<
+			std::setw(10) << writes_s <<
+			std::setw(10) << mb_s;
+		if (last == 0) {
+			std::cout << std::setw(12) << "-";
+		} else {
+			std::cout << std::setw(12) << (now - last) / 1e6;
+		}
+		std::cout << std::setw(12) << stats.callbacks.load() <<
+			std::setw(10) << stats.missed.load() <<
+			std::setw(14) << stats.max_callback_ns.load() / 1e3 << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		std::cout << "usage: shm_stat <memory_name> [object_name] " <<
+			"[period_ms] [iterations]" << std::endl;
+		return 1;
+	}
+	std::string name_shm = argv[1];
+	std::string name_object = argc > 2 ? argv[2] : "SharedObject";
+	int period_ms = argc > 3 ? std::atoi(argv[3]) : 1000;
+	int iterations = argc > 4 ? std::atoi(argv[4]) : 0;
+	if (period_ms < 1) period_ms = 1000;
+
+	co::shm::SharedMemoryManager smm;
+	if (!smm.detect(name_shm, name_object)) {
+		std::cout << "[e] Unable to detect: " << name_shm << std::endl;
+		return 1;
+	}
+
+	std::vector<ObjectSnapshot> previous(smm.num_items());
+	for (size_t i = 0; i < smm.num_items(); ++i) {
+		previous[i].write_count = smm.shared_object(i)->stats_.write_count;
+		previous[i].bytes_written = smm.shared_object(i)->stats_.bytes_written;
+	}
+	for (int n = 0; iterations == 0 || n < iterations; ++n) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(period_ms));
+		print_stats(smm, previous, period_ms / 1000.0);
+	}
+	return 0;
+}
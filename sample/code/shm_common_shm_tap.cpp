@@ -0,0 +1,179 @@
+/**
+* @file shm_common_shm_tap.cpp
+* @brief It records the updates of a shared memory in a file, and it
+*        replays them in a new memory at the original rate.
+*
+* @section LICENSE
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR/AUTHORS BE LIABLE FOR ANY
+* DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+* LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+* ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+* THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* @author Alessandro Moro (alessandromoro.italy@gmail.com)
+* @bug No known bugs.
+* @version 0.1.0.0
+*
+* @usage
+*   shm_tap record <memory_name> <file> [object_name=SharedObject]
+*                  [objects=all (i.e. rgb,depth)] [seconds=10]
+*   shm_tap replay <file> [speed=1 (0: as fast as possible)]
+*                  [memory_name=recorded name]
+*
+*   record attaches to the memory, listens for the chosen objects
+*   (process_id) and appends each update (object id, sequence, producer
+*   time, vectors, string and raw memory) to the file.
+*   replay creates the recorded memory with parse and publishes the
+*   updates with the recorded intervals divided by speed.
+*/
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstdlib>
+
+#include "commonobjects/shm_common/SharedDataDerivedSample.hpp"
+
+namespace
+{
+
+/** @brief It records the updates of a memory
+*/
+int record(const std::string &name_shm, const std::string &filename,
+	const std::string &name_object, const std::string &objects,
+	int seconds) {
+	co::shm::SharedDataDerivedSample shared_data;
+	if (!shared_data.detect(name_shm, name_object)) {
+		std::cout << "[e] Unable to detect: " << name_shm << std::endl;
+		return 1;
+	}
+	// the memory is only detected: nothing is created in it
+	co::shm::char_string *layout_str =
+		shared_data.smm().find_string("layout");
+	std::string layout = layout_str != nullptr ? layout_str->c_str() : "";
+	if (layout.empty()) {
+		std::cout << "[e] The memory has no layout (parse message)" <<
+			std::endl;
+		return 1;
+	}
+
+	// objects to record
+	std::vector<size_t> which;
+	if (objects == "all") {
+		// the frame queues are not recorded
+		for (size_t i = 0; i < shared_data.smm().num_items(); ++i) {
+			if (shared_data.tap_supported(i)) which.push_back(i);
+		}
+	} else {
+		std::stringstream ss(objects);
+		std::string name;
+		while (std::getline(ss, name, ',')) {
+			size_t id = shared_data.get_key_id(name);
+			if (id == co::shm::kInvalidKeyID) {
+				std::cout << "[e] Unknown object: " << name << std::endl;
+				return 1;
+			}
+			which.push_back(id);
+		}
+	}
+
+	co::shm::SharedTapWriter writer;
+	if (!writer.open(filename, name_shm, name_object, layout)) return 1;
+
+	// the callbacks of the objects run in different threads
+	std::mutex mtx;
+	size_t num_records = 0, num_skipped = 0;
+	shared_data.registerCallback([&](size_t id,
+		co::shm::SharedMemoryManager &) {
+		co::shm::SharedTapRecord record;
+		if (!shared_data.tap_capture(id, record)) {
+			std::lock_guard<std::mutex> lock(mtx);
+			++num_skipped;
+			return;
+		}
+		std::lock_guard<std::mutex> lock(mtx);
+		writer.write(record);
+		++num_records;
+	});
+	shared_data.start(which, 0);
+	std::cout << "Recording " << which.size() << " objects for " <<
+		seconds << " s: " << filename << std::endl;
+	std::this_thread::sleep_for(std::chrono::seconds(seconds));
+	shared_data.stop();
+	writer.close();
+	std::cout << "Recorded " << num_records << " updates (" << num_skipped <<
+		" not recorded)" << std::endl;
+	return 0;
+}
+
+/** @brief It replays a recorded file
+*/
+int replay(const std::string &filename, double speed,
+	const std::string &name_shm) {
+	co::shm::SharedTapReader reader;
+	if (!reader.open(filename)) return 1;
+	std::string name = name_shm.empty() ? reader.name_shm() : name_shm;
+
+	co::shm::SharedDataDerivedSample shared_data;
+	if (shared_data.parse(name, reader.name_object(), reader.layout()) !=
+		co::shm::kSharedNoError) {
+		std::cout << "[e] Unable to create: " << name << std::endl;
+		return 1;
+	}
+
+	co::shm::SharedTapRecord record;
+	size_t num_records = 0;
+	uint64_t first_ns = 0;
+	auto start = std::chrono::steady_clock::now();
+	while (reader.read(record)) {
+		if (num_records == 0) first_ns = record.timestamp_ns;
+		if (speed > 0 && record.timestamp_ns > first_ns) {
+			std::this_thread::sleep_until(start + std::chrono::nanoseconds(
+				static_cast<int64_t>((record.timestamp_ns - first_ns) / speed)));
+		}
+		if (!shared_data.tap_publish(record)) {
+			std::cout << "[w] Unable to publish the object " << record.id <<
+				std::endl;
+		}
+		++num_records;
+	}
+	std::cout << "Replayed " << num_records << " updates in " <<
+		std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count() << " s" <<
+		std::endl;
+	return 0;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+	std::string mode = argc > 1 ? argv[1] : "";
+	if (mode == "record" && argc >= 4) {
+		return record(argv[2], argv[3],
+			argc > 4 ? argv[4] : "SharedObject",
+			argc > 5 ? argv[5] : "all",
+			argc > 6 ? std::atoi(argv[6]) : 10);
+	}
+	if (mode == "replay" && argc >= 3) {
+		return replay(argv[2], argc > 3 ? std::atof(argv[3]) : 1.0,
+			argc > 4 ? argv[4] : "");
+	}
+	std::cout << "usage: shm_tap record <memory_name> <file> [object_name] " <<
+		"[objects] [seconds]" << std::endl;
+	std::cout << "       shm_tap replay <file> [speed] [memory_name]" <<
+		std::endl;
+	return 1;
+}